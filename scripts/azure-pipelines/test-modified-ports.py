@@ -0,0 +1,492 @@
+# Copyright (c) Microsoft Corporation.
+# SPDX-License-Identifier: MIT
+#
+
+"""Tests the ports affected by a change, in parallel.
+
+Unlike test-modified-ports.ps1, which lets 'vcpkg ci' build every port of a triplet, this
+runner only tests the ports that a change can affect: the ports modified since the base
+revision and everything that depends on them, as far as the triplet supports them and
+ci.baseline.txt does not skip them. Each port is installed by its own 'vcpkg install' in one
+of several workers. Every worker has its own installed, packages and buildtrees directories,
+and all of them share a 'files' binary cache, so dependencies built by one worker are restored
+by the others. Ports are started as soon as all of their dependencies that are tested as well
+have passed, longest remaining chain of dependents first.
+
+The build time of each port is recorded in the working root and estimates the chains of the
+next run.
+"""
+
+import os
+import re
+import sys
+import json
+import time
+import shutil
+import argparse
+import subprocess
+import multiprocessing
+
+from concurrent.futures import ThreadPoolExecutor, wait, FIRST_COMPLETED
+
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+VCPKG_ROOT = os.path.normpath(os.path.join(SCRIPT_DIRECTORY, '../..'))
+PORTS_DIRECTORY = os.path.join(VCPKG_ROOT, 'ports')
+CI_BASELINE_PATH = os.path.join(VCPKG_ROOT, 'scripts/ci.baseline.txt')
+DEFAULT_ESTIMATE = 60
+
+# Changes to these affect the build of every port.
+GLOBAL_PATHS = ['scripts/ports.cmake', 'scripts/cmake/', 'scripts/buildsystems/',
+                'scripts/toolchains/', 'scripts/get_cmake_vars/', 'triplets/']
+
+SYSTEM_IDENTIFIERS = {
+    '': ['windows'],
+    'WindowsStore': ['windows', 'uwp'],
+    'Linux': ['linux'],
+    'Darwin': ['osx'],
+    'Android': ['android'],
+    'FreeBSD': ['freebsd'],
+    'Emscripten': ['emscripten'],
+    'MinGW': ['windows', 'mingw'],
+}
+
+
+def get_triplet_identifiers(triplet):
+    for triplet_directory in ['triplets', 'triplets/community']:
+        triplet_path = os.path.join(VCPKG_ROOT, triplet_directory, f'{triplet}.cmake')
+        if os.path.exists(triplet_path):
+            break
+    else:
+        print(f'Error: Incorrect triplet \'{triplet}\', please supply a valid triplet.', file=sys.stderr)
+        sys.exit(1)
+
+    with open(triplet_path, 'r') as triplet_file:
+        variables = dict(re.findall(r'set\s*\(\s*(VCPKG_\w+)\s+"?([^")\s]*)"?\s*\)', triplet_file.read()))
+    identifiers = set(SYSTEM_IDENTIFIERS.get(variables.get('VCPKG_CMAKE_SYSTEM_NAME', ''), []))
+    identifiers.add(variables.get('VCPKG_TARGET_ARCHITECTURE', ''))
+    if variables.get('VCPKG_LIBRARY_LINKAGE') == 'static':
+        identifiers.add('static')
+    if variables.get('VCPKG_CRT_LINKAGE') == 'static':
+        identifiers.add('staticcrt')
+    return identifiers
+
+
+def evaluate_platform(expression, identifiers):
+    # Grammar of platform expressions: alternatives separated by '|' or ',',
+    # made of terms joined by '&', which are identifiers, negations or groups.
+    tokens = re.findall(r'[A-Za-z0-9_-]+|[!&|,()]', expression or '')
+    position = 0
+
+    def peek():
+        return tokens[position] if position < len(tokens) else None
+
+    def take():
+        nonlocal position
+        position += 1
+        return tokens[position - 1]
+
+    def parse_or():
+        value = parse_and()
+        while peek() in ('|', ','):
+            take()
+            value = parse_and() or value
+        return value
+
+    def parse_and():
+        value = parse_unary()
+        while peek() == '&':
+            take()
+            value = parse_unary() and value
+        return value
+
+    def parse_unary():
+        token = take() if peek() is not None else None
+        if token == '!':
+            return not parse_unary()
+        if token == '(':
+            value = parse_or()
+            if peek() == ')':
+                take()
+            return value
+        return token in identifiers
+
+    return parse_or() if tokens else True
+
+
+def split_dependency_list(text):
+    items, depth, current = [], 0, ''
+    for character in text:
+        if character in '[(':
+            depth += 1
+        elif character in '])':
+            depth -= 1
+        if character == ',' and depth == 0:
+            items.append(current)
+            current = ''
+        else:
+            current += character
+    items.append(current)
+
+    dependencies = []
+    for item in items:
+        match = re.match(r'\s*([A-Za-z0-9-]+)\s*(?:\[([^\]]*)\])?\s*(?:\(([^)]*)\))?\s*$', item)
+        if match:
+            features = [feature.strip() for feature in (match.group(2) or '').split(',') if feature.strip()]
+            dependencies.append((match.group(1), features, match.group(3) or ''))
+    return dependencies
+
+
+def load_port(port_name):
+    """Returns the dependencies of a port as (name, features, platform) tuples:
+    those of the core, those of each feature, the default features and the supports expression."""
+    port_directory = os.path.join(PORTS_DIRECTORY, port_name)
+    manifest_path = os.path.join(port_directory, 'vcpkg.json')
+    if os.path.exists(manifest_path):
+        with open(manifest_path, 'r', encoding='utf-8') as manifest_file:
+            manifest = json.load(manifest_file)
+
+        def get_dependencies(dependencies):
+            result = []
+            for dependency in dependencies:
+                if isinstance(dependency, str):
+                    result.append((dependency, [], ''))
+                else:
+                    result.append((dependency['name'], dependency.get('features', []),
+                                   dependency.get('platform', '')))
+            return result
+
+        features = {name: get_dependencies(feature.get('dependencies', []))
+                    for name, feature in manifest.get('features', {}).items()}
+        default_features = [feature if isinstance(feature, str) else feature['name']
+                            for feature in manifest.get('default-features', [])]
+        return {
+            'dependencies': get_dependencies(manifest.get('dependencies', [])),
+            'features': features,
+            'default-features': default_features,
+            'supports': manifest.get('supports', ''),
+        }
+
+    with open(os.path.join(port_directory, 'CONTROL'), 'r', encoding='utf-8') as control_file:
+        paragraphs = [paragraph for paragraph in re.split(r'\n\s*\n', control_file.read()) if paragraph.strip()]
+    port = {'dependencies': [], 'features': {}, 'default-features': [], 'supports': ''}
+    for i, paragraph in enumerate(paragraphs):
+        fields = dict(re.findall(r'^([A-Za-z-]+):[ \t]*(.*)$', paragraph, re.MULTILINE))
+        dependencies = split_dependency_list(fields['Build-Depends']) if fields.get('Build-Depends') else []
+        if i == 0:
+            port['dependencies'] = dependencies
+            port['default-features'] = [feature.strip() for feature in fields.get('Default-Features', '').split(',')
+                                        if feature.strip()]
+            port['supports'] = fields.get('Supports', '')
+        elif 'Feature' in fields:
+            port['features'][fields['Feature'].strip()] = dependencies
+    return port
+
+
+def build_dependency_graph(ports, identifiers):
+    # Ports are tested with their default features, plus the features their dependents ask for.
+    requested = {port_name: set(port['default-features']) for port_name, port in ports.items()}
+    graph = {}
+    changed = True
+    while changed:
+        changed = False
+        for port_name, port in ports.items():
+            dependencies = list(port['dependencies'])
+            for feature in requested[port_name]:
+                dependencies += port['features'].get(feature, [])
+            edges = set()
+            for name, features, platform in dependencies:
+                if name not in ports or not evaluate_platform(platform, identifiers):
+                    continue
+                new_features = set(feature for feature in features if feature != 'core') - requested[name]
+                if new_features:
+                    requested[name] |= new_features
+                    changed = True
+                if name != port_name:
+                    edges.add(name)
+            graph[port_name] = edges
+    return graph
+
+
+def load_ci_baseline(triplet):
+    states = {}
+    with open(CI_BASELINE_PATH, 'r') as baseline_file:
+        for line in baseline_file:
+            line = re.sub(r'\s', '', line.split('#', 1)[0])
+            match = re.match(r'([^:]+):([^=]+)=(\w+)$', line)
+            if match and match.group(2) == triplet:
+                states[match.group(1)] = match.group(3)
+    return states
+
+
+def get_modified_ports(base_revision):
+    merge_base = subprocess.run(['git', '-C', VCPKG_ROOT, 'merge-base', base_revision, 'HEAD'],
+                                capture_output=True, encoding='utf-8')
+    if merge_base.returncode != 0:
+        print(f'Error: Failed to find the merge base with {base_revision}:', merge_base.stderr.strip(),
+              file=sys.stderr)
+        sys.exit(1)
+    # Compare the working tree, so uncommitted changes are tested as well.
+    output = subprocess.run(['git', '-C', VCPKG_ROOT, 'diff', '--name-only', merge_base.stdout.strip()],
+                            capture_output=True, encoding='utf-8')
+    if output.returncode != 0:
+        print(f'Error: Failed to diff against {base_revision}:', output.stderr.strip(), file=sys.stderr)
+        sys.exit(1)
+
+    modified_ports = set()
+    global_change = None
+    for path in output.stdout.splitlines():
+        if path.startswith('ports/'):
+            modified_ports.add(path.split('/')[1])
+        elif any(path.startswith(global_path) for global_path in GLOBAL_PATHS):
+            global_change = global_change or path
+    return modified_ports, global_change
+
+
+def get_transitive_dependencies(graph, port_name, memo):
+    if port_name not in memo:
+        memo[port_name] = set()
+        result = set()
+        for dependency in graph.get(port_name, []):
+            result.add(dependency)
+            result |= get_transitive_dependencies(graph, dependency, memo)
+        memo[port_name] = result
+    return memo[port_name]
+
+
+def plan_tests(graph, modified_ports, tested_ports, estimates):
+    """Returns the tested ports in the closure of the modified ports, each with the tested ports
+    it waits for and its priority, the estimated duration of the longest chain it starts."""
+    dependents = {port_name: set() for port_name in graph}
+    for port_name, dependencies in graph.items():
+        for dependency in dependencies:
+            dependents[dependency].add(port_name)
+
+    closure = set()
+    pending = [port_name for port_name in modified_ports if port_name in graph]
+    while pending:
+        port_name = pending.pop()
+        if port_name in closure:
+            continue
+        closure.add(port_name)
+        pending.extend(dependents[port_name])
+
+    memo = {}
+    planned = sorted(port_name for port_name in closure if port_name in tested_ports)
+    waits_for = {port_name: get_transitive_dependencies(graph, port_name, memo) & set(planned)
+                 for port_name in planned}
+    unblocks = {port_name: set() for port_name in planned}
+    for port_name in planned:
+        for dependency in waits_for[port_name]:
+            unblocks[dependency].add(port_name)
+
+    priorities = {}
+    in_progress = set()
+
+    def get_priority(port_name):
+        if port_name in in_progress:
+            # a dependency cycle; run_tests() reports the ports on it as failed
+            return 0
+        if port_name not in priorities:
+            in_progress.add(port_name)
+            priorities[port_name] = estimates.get(port_name, DEFAULT_ESTIMATE) + max(
+                [get_priority(dependent) for dependent in unblocks[port_name]], default=0)
+            in_progress.discard(port_name)
+        return priorities[port_name]
+
+    sys.setrecursionlimit(max(sys.getrecursionlimit(), 4 * len(planned) + 100))
+    for port_name in planned:
+        get_priority(port_name)
+    return planned, waits_for, priorities
+
+
+def test_port(port_name, slot, args):
+    slot_root = os.path.join(args.working_root, f'worker-{slot}')
+    installed_root = os.path.join(slot_root, 'installed')
+    packages_root = os.path.join(slot_root, 'packages')
+    buildtrees_root = os.path.join(slot_root, 'buildtrees')
+    # every port starts from an empty installed tree; its dependencies come from the binary cache
+    shutil.rmtree(installed_root, ignore_errors=True)
+    shutil.rmtree(packages_root, ignore_errors=True)
+
+    command = [args.vcpkg, 'install', f'{port_name}:{args.triplet}',
+               f'--x-buildtrees-root={buildtrees_root}',
+               f'--x-install-root={installed_root}',
+               f'--x-packages-root={packages_root}',
+               f'--overlay-ports={os.path.join(VCPKG_ROOT, "scripts/test_ports")}']
+    if args.archives_root:
+        command += ['--binarycaching', f'--binarysource=clear;files,{args.archives_root},readwrite']
+    else:
+        command += ['--no-binarycaching']
+
+    start_time = time.time()
+    output = subprocess.run(command, cwd=VCPKG_ROOT, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            encoding='utf-8', errors='replace')
+    elapsed_time = time.time() - start_time
+    log_path = os.path.join(args.working_root, 'logs', f'{port_name}.log')
+    with open(log_path, 'w') as log_file:
+        log_file.write(output.stdout)
+    built = f'Building package {port_name}:{args.triplet}' in output.stdout
+    return 'pass' if output.returncode == 0 else 'fail', elapsed_time, built
+
+
+def run_tests(planned, waits_for, priorities, baseline, args):
+    os.makedirs(os.path.join(args.working_root, 'logs'), exist_ok=True)
+    results = {}
+    remaining = set(planned)
+    running = {}
+    free_slots = list(range(args.jobs, 0, -1))
+    with ThreadPoolExecutor(max_workers=args.jobs) as executor:
+        while remaining or running:
+            # Ports whose dependencies did not pass cannot pass either.
+            for port_name in sorted(remaining):
+                if any(results.get(dependency, {}).get('result') in ('fail', 'cascade')
+                       for dependency in waits_for[port_name]):
+                    results[port_name] = {'result': 'cascade', 'seconds': 0, 'built': False}
+                    remaining.discard(port_name)
+
+            ready = [port_name for port_name in remaining
+                     if all(dependency in results for dependency in waits_for[port_name])]
+            ready.sort(key=lambda port_name: (-priorities[port_name], port_name))
+            for port_name in ready[:len(free_slots)]:
+                slot = free_slots.pop()
+                remaining.discard(port_name)
+                print(f'Testing {port_name}:{args.triplet} (worker {slot})', flush=True)
+                running[executor.submit(test_port, port_name, slot, args)] = (port_name, slot)
+
+            if not running:
+                if remaining:
+                    # Nothing can start and nothing will finish: the remaining ports wait for each other.
+                    message = f'blocked by a dependency cycle among {", ".join(sorted(remaining))}'
+                    for port_name in sorted(remaining):
+                        results[port_name] = {'result': 'fail', 'seconds': 0, 'built': False}
+                        with open(os.path.join(args.working_root, 'logs', f'{port_name}.log'), 'w') as log_file:
+                            log_file.write(f'{message}\n')
+                        print(f'{port_name}:{args.triplet}: FAIL, {message}', flush=True)
+                    remaining.clear()
+                continue
+            done, _ = wait(running, return_when=FIRST_COMPLETED)
+            for future in done:
+                port_name, slot = running.pop(future)
+                free_slots.append(slot)
+                result, seconds, built = future.result()
+                results[port_name] = {'result': result, 'seconds': seconds, 'built': built}
+                expected = baseline.get(port_name, 'pass')
+                print(f'{port_name}:{args.triplet}: {result.upper()} in {seconds:.1f} s'
+                      f'{"" if built else " (binary cache)"}, expected {expected}', flush=True)
+    return results
+
+
+def report(results, baseline, args):
+    regressions = []
+    print(f'\n{"port":<40} {"result":<8} {"expected":<8} {"seconds":>8}  built')
+    for port_name, result in sorted(results.items(), key=lambda item: -item[1]['seconds']):
+        expected = baseline.get(port_name, 'pass')
+        print(f'{port_name:<40} {result["result"]:<8} {expected:<8} {result["seconds"]:>8.1f}  '
+              f'{"yes" if result["built"] else "no"}')
+        if result['result'] == 'fail' and expected == 'pass':
+            regressions.append(f'{port_name}:{args.triplet}: REGRESSION, see {port_name}.log')
+        elif result['result'] == 'pass' and expected == 'fail' and not args.passing_is_passing:
+            regressions.append(f'{port_name}:{args.triplet}: PASSING, REMOVE FROM FAIL LIST')
+
+    results_path = os.path.join(args.artifact_staging_directory, f'results-{args.triplet}.json')
+    with open(results_path, 'w') as results_file:
+        json.dump(results, results_file, indent=2, sort_keys=True)
+
+    for regression in regressions:
+        print(regression, file=sys.stderr)
+    return not regressions
+
+
+def load_estimates(timings_path):
+    if not os.path.exists(timings_path):
+        return {}
+    with open(timings_path, 'r') as timings_file:
+        return json.load(timings_file)
+
+
+def save_estimates(timings_path, estimates, results):
+    # Only builds measure a port; restoring it from the binary cache says nothing about its build time.
+    for port_name, result in results.items():
+        if result['built']:
+            estimates[port_name] = round(result['seconds'], 1)
+    with open(timings_path, 'w') as timings_file:
+        json.dump(estimates, timings_file, indent=2, sort_keys=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Test the ports affected by a change in parallel workers.')
+    parser.add_argument('--triplet', required=True, help='the triplet to test')
+    parser.add_argument('--working-root', required=True,
+                        help='scratch space for the workers, the logs and the recorded build times')
+    parser.add_argument('--base', default='origin/master',
+                        help='the revision the change is compared against (default: %(default)s)')
+    parser.add_argument('--ports', nargs='+', metavar='PORT',
+                        help='test these ports and their dependents instead of the modified ports')
+    parser.add_argument('--all', action='store_true', help='test all ports')
+    parser.add_argument('--archives-root',
+                        help='directory of the shared "files" binary cache; binary caching is off without it')
+    parser.add_argument('--jobs', type=int, default=max(multiprocessing.cpu_count() // 4, 1),
+                        help='number of ports tested at the same time (default: %(default)s)')
+    parser.add_argument('--vcpkg', default=os.path.join(VCPKG_ROOT, 'vcpkg'),
+                        help='the vcpkg executable (default: %(default)s)')
+    parser.add_argument('--artifact-staging-directory', default='.',
+                        help='where the results are written (default: the current directory)')
+    parser.add_argument('--skip-failures', action='store_true',
+                        help='do not test ports that ci.baseline.txt expects to fail')
+    parser.add_argument('--passing-is-passing', action='store_true',
+                        help='do not report ports that pass although they are expected to fail')
+    parser.add_argument('--dry-run', action='store_true', help='only print the ports that would be tested')
+    args = parser.parse_args()
+    args.working_root = os.path.abspath(args.working_root)
+    if args.archives_root:
+        args.archives_root = os.path.abspath(args.archives_root)
+    os.environ.setdefault('VCPKG_DOWNLOADS', os.path.join(args.working_root, 'downloads'))
+
+    identifiers = get_triplet_identifiers(args.triplet)
+    baseline = load_ci_baseline(args.triplet)
+    skipped_states = ('skip', 'fail') if args.skip_failures else ('skip',)
+    ports = {port_name: load_port(port_name) for port_name in sorted(os.listdir(PORTS_DIRECTORY))
+             if os.path.isdir(os.path.join(PORTS_DIRECTORY, port_name))}
+    graph = build_dependency_graph(ports, identifiers)
+    tested_ports = set(port_name for port_name, port in ports.items()
+                       if evaluate_platform(port['supports'], identifiers)
+                       and baseline.get(port_name) not in skipped_states)
+
+    if args.all:
+        modified_ports = set(ports)
+    elif args.ports:
+        modified_ports = set(args.ports)
+    else:
+        modified_ports, global_change = get_modified_ports(args.base)
+        if global_change:
+            print(f'{global_change} affects all ports')
+            modified_ports = set(ports)
+    unknown_ports = sorted(port_name for port_name in modified_ports if port_name not in ports)
+    if unknown_ports:
+        print(f'Not testing removed or unknown ports: {", ".join(unknown_ports)}')
+
+    os.makedirs(args.working_root, exist_ok=True)
+    timings_path = os.path.join(args.working_root, f'port-timings-{args.triplet}.json')
+    estimates = load_estimates(timings_path)
+    planned, waits_for, priorities = plan_tests(graph, modified_ports, tested_ports, estimates)
+    print(f'{len(modified_ports)} ports modified, testing {len(planned)} ports with {args.jobs} workers')
+    if args.dry_run:
+        for port_name in sorted(planned, key=lambda port_name: (-priorities[port_name], port_name)):
+            print(f'{port_name:<40} waits for {len(waits_for[port_name]):>4} ports, '
+                  f'critical path {priorities[port_name]:.0f} s')
+        return
+
+    start_time = time.time()
+    results = run_tests(planned, waits_for, priorities, baseline, args)
+    save_estimates(timings_path, estimates, results)
+    passed = report(results, baseline, args)
+    elapsed_time = time.time() - start_time
+    print(f'\nElapsed time: {elapsed_time:.2f} seconds')
+    if not passed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,108 @@
+import os
+import sys
+import time
+import shutil
+import hashlib
+import argparse
+import tempfile
+import subprocess
+
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+CHUNK_SIZE = 1024 * 1024
+
+# Calls vcpkg_download_distfile() on a file which is already in the downloads directory,
+# which is what every build of a port does once its sources were downloaded.
+DRIVER = '''
+cmake_minimum_required(VERSION 3.20)
+list(APPEND CMAKE_MODULE_PATH [==[{scripts}/cmake]==])
+include(execute_process)
+include(z_vcpkg_function_arguments)
+include(z_vcpkg_forward_output_variable)
+include(vcpkg_download_distfile)
+set(DOWNLOADS [==[{downloads}]==])
+set(VCPKG_PARANOID_HASH_CHECK {paranoid})
+foreach(i RANGE 1 {calls})
+    vcpkg_download_distfile(archive
+        URLS "file:///nonexistent/benchmark.bin"
+        FILENAME "benchmark.bin"
+        SHA512 {sha512}
+        QUIET
+    )
+endforeach()
+'''
+
+
+def write_file(path, size):
+    hash = hashlib.sha512()
+    chunk = os.urandom(CHUNK_SIZE)
+    with open(path, 'wb') as output_file:
+        for _ in range(size):
+            output_file.write(chunk)
+            hash.update(chunk)
+    return hash.hexdigest()
+
+
+def run_driver(driver_path):
+    start_time = time.time()
+    result = subprocess.run(['cmake', '-P', driver_path],
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    elapsed_time = time.time() - start_time
+    if result.returncode != 0:
+        print(result.stdout, file=sys.stderr)
+        print(f'Error: cmake -P {driver_path} failed', file=sys.stderr)
+        sys.exit(1)
+    return elapsed_time
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measure the time vcpkg_download_distfile() takes for an already downloaded file, '
+                    'with and without the recorded hash in ${DOWNLOADS}/verified-hashes.')
+    parser.add_argument('--size', type=int, default=256,
+                        help='size of the downloaded file in MiB (default: 256)')
+    parser.add_argument('--calls', type=int, default=10,
+                        help='number of vcpkg_download_distfile() calls per run (default: 10)')
+    parser.add_argument('--runs', type=int, default=3,
+                        help='number of runs per variant; the fastest one is reported (default: 3)')
+    args = parser.parse_args()
+
+    variants = [
+        ('always re-hash', 'ON'),
+        ('recorded hash', 'OFF'),
+    ]
+
+    working_directory = tempfile.mkdtemp(prefix='vcpkg-benchmark-')
+    try:
+        downloads_directory = os.path.join(working_directory, 'downloads')
+        os.mkdir(downloads_directory)
+        sha512 = write_file(os.path.join(downloads_directory, 'benchmark.bin'), args.size)
+
+        driver_paths = {}
+        for name, paranoid in variants:
+            driver_paths[name] = os.path.join(working_directory, f'driver-{paranoid}.cmake')
+            with open(driver_paths[name], 'w') as driver_file:
+                driver_file.write(DRIVER.format(
+                    scripts=SCRIPT_DIRECTORY.replace('\\', '/'),
+                    downloads=downloads_directory.replace('\\', '/'),
+                    paranoid=paranoid, calls=args.calls, sha512=sha512))
+        # the first cache hit hashes the file and records it, as the first build after a download does
+        run_driver(driver_paths['recorded hash'])
+
+        times = {}
+        for _ in range(args.runs):
+            # interleave the variants, so that they share any drift of the machine
+            for name, _ in variants:
+                elapsed_time = run_driver(driver_paths[name])
+                times[name] = min(times.get(name, elapsed_time), elapsed_time)
+    finally:
+        shutil.rmtree(working_directory, ignore_errors=True)
+
+    print(f'{args.calls} cache hits on a {args.size} MiB file (fastest of {args.runs} runs):')
+    for name, _ in variants:
+        per_call = times[name] * 1000 / args.calls
+        print(f'  {name:<16} {times[name]:7.2f} seconds  {per_call:8.2f} ms per call')
+
+
+if __name__ == "__main__":
+    main()
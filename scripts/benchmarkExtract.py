@@ -0,0 +1,135 @@
+import io
+import os
+import sys
+import time
+import random
+import shutil
+import string
+import tarfile
+import argparse
+import tempfile
+import subprocess
+
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+
+# The decompressors z_vcpkg_extract_archive() looks for, by archive format.
+FORMATS = {
+    'gz': ['pigz'],
+    'xz': ['xz'],
+    'bz2': ['lbzip2', 'pbzip2'],
+}
+
+DRIVER = '''
+cmake_minimum_required(VERSION 3.20)
+list(APPEND CMAKE_MODULE_PATH [==[{scripts}/cmake]==])
+include(execute_process)
+include(z_vcpkg_function_arguments)
+include(z_vcpkg_forward_output_variable)
+include(z_vcpkg_prettify_command_line)
+include(vcpkg_execute_in_download_mode)
+include(vcpkg_execute_required_process)
+include(z_vcpkg_timing)
+include(z_vcpkg_extract_archive)
+set(CURRENT_BUILDTREES_DIR [==[{buildtrees}]==])
+set(VCPKG_CONCURRENCY {concurrency})
+file(REMOVE_RECURSE [==[{destination}]==])
+if({parallel})
+    z_vcpkg_extract_archive(ARCHIVE [==[{archive}]==] DESTINATION [==[{destination}]==])
+else()
+    file(MAKE_DIRECTORY [==[{destination}]==])
+    vcpkg_execute_required_process(
+        ALLOW_IN_DOWNLOAD_MODE
+        COMMAND "${{CMAKE_COMMAND}}" -E tar xjf [==[{archive}]==]
+        WORKING_DIRECTORY [==[{destination}]==]
+        LOGNAME extract
+    )
+endif()
+'''
+
+
+def write_archive(archive_path, archive_format, file_count, file_size):
+    # text from a fixed vocabulary compresses about as well as source code
+    generator = random.Random(0)
+    words = [''.join(generator.choice(string.ascii_lowercase) for _ in range(generator.randint(2, 10)))
+             for _ in range(2048)]
+    with tarfile.open(archive_path, f'w:{archive_format}') as archive:
+        for i in range(file_count):
+            text = ' '.join(generator.choices(words, k=file_size // 6)).encode()[:file_size]
+            info = tarfile.TarInfo(f'source/dir{i % 64}/file{i}.txt')
+            info.size = len(text)
+            archive.addfile(info, io.BytesIO(text))
+
+
+def run_driver(driver_path):
+    start_time = time.time()
+    result = subprocess.run(['cmake', '-P', driver_path],
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    elapsed_time = time.time() - start_time
+    if result.returncode != 0:
+        print(result.stdout, file=sys.stderr)
+        print(f'Error: cmake -P {driver_path} failed', file=sys.stderr)
+        sys.exit(1)
+    return elapsed_time
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measure the time to extract a source archive with cmake -E tar '
+                    'and with the multi-threaded decompressor pipeline of z_vcpkg_extract_archive().')
+    parser.add_argument('--format', choices=sorted(FORMATS), default='gz',
+                        help='compression of the archive (default: gz)')
+    parser.add_argument('--files', type=int, default=4000,
+                        help='number of files in the archive (default: 4000)')
+    parser.add_argument('--file-size', type=int, default=32 * 1024,
+                        help='size of each file in bytes (default: 32768)')
+    parser.add_argument('--concurrency', type=int, default=os.cpu_count(),
+                        help='value of VCPKG_CONCURRENCY (default: the number of cores)')
+    parser.add_argument('--runs', type=int, default=3,
+                        help='number of extractions per variant; the fastest one is reported (default: 3)')
+    args = parser.parse_args()
+
+    decompressors = [program for program in FORMATS[args.format] if shutil.which(program)]
+    if not decompressors:
+        print(f'Warning: none of {", ".join(FORMATS[args.format])} was found; '
+              'both variants extract with cmake -E tar', file=sys.stderr)
+    variants = [
+        ('cmake -E tar', 'OFF'),
+        ('decompressor pipeline', 'ON'),
+    ]
+
+    working_directory = tempfile.mkdtemp(prefix='vcpkg-benchmark-')
+    try:
+        archive_path = os.path.join(working_directory, f'source.tar.{args.format}')
+        write_archive(archive_path, args.format, args.files, args.file_size)
+        archive_size = os.path.getsize(archive_path) / (1024 * 1024)
+
+        driver_paths = {}
+        for name, parallel in variants:
+            driver_paths[name] = os.path.join(working_directory, f'driver-{parallel}.cmake')
+            with open(driver_paths[name], 'w') as driver_file:
+                driver_file.write(DRIVER.format(
+                    scripts=SCRIPT_DIRECTORY.replace('\\', '/'),
+                    buildtrees=working_directory.replace('\\', '/'),
+                    destination=os.path.join(working_directory, 'extracted').replace('\\', '/'),
+                    archive=archive_path.replace('\\', '/'),
+                    concurrency=args.concurrency, parallel=parallel))
+
+        times = {}
+        for _ in range(args.runs):
+            # interleave the variants, so that they share any drift of the machine
+            for name, _ in variants:
+                elapsed_time = run_driver(driver_paths[name])
+                times[name] = min(times.get(name, elapsed_time), elapsed_time)
+    finally:
+        shutil.rmtree(working_directory, ignore_errors=True)
+
+    print(f'Extracting {args.files} files from a {archive_size:.1f} MiB .tar.{args.format} '
+          f'(fastest of {args.runs} runs):')
+    for name, _ in variants:
+        speedup = times['cmake -E tar'] / times[name]
+        print(f'  {name:<22} {times[name]:7.2f} seconds  {speedup:5.2f}x')
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,90 @@
+import os
+import sys
+import time
+import shutil
+import argparse
+import tempfile
+import subprocess
+
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+TOOLCHAIN_FILE = os.path.join(SCRIPT_DIRECTORY, 'buildsystems', 'vcpkg.cmake')
+
+# Each check runs one try_compile() project, which loads the toolchain again.
+HEADERS = ['stdio.h', 'stdlib.h', 'string.h', 'stddef.h', 'limits.h']
+
+
+def write_project(project_directory, check_count):
+    lines = [
+        'cmake_minimum_required(VERSION 3.1)',
+        'project(benchmark_try_compile C)',
+        'include(CheckIncludeFile)',
+    ]
+    for i in range(check_count):
+        lines.append(f'check_include_file({HEADERS[i % len(HEADERS)]} HAVE_HEADER_{i})')
+    with open(os.path.join(project_directory, 'CMakeLists.txt'), 'w') as project_file:
+        project_file.write('\n'.join(lines) + '\n')
+
+
+def configure(project_directory, build_directory, options):
+    shutil.rmtree(build_directory, ignore_errors=True)
+    command = ['cmake', '-S', project_directory, '-B', build_directory] + options
+    start_time = time.time()
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    elapsed_time = time.time() - start_time
+    if result.returncode != 0:
+        print(result.stdout, file=sys.stderr)
+        print(f'Error: {" ".join(command)} failed', file=sys.stderr)
+        sys.exit(1)
+    return elapsed_time
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measure the configure time of a project with many try_compile() checks, '
+                    'with and without the try_compile fast path of the vcpkg toolchain.')
+    parser.add_argument('--checks', type=int, default=500,
+                        help='number of check_include_file() calls in the project (default: 500)')
+    parser.add_argument('--runs', type=int, default=3,
+                        help='number of configures per variant; the fastest one is reported (default: 3)')
+    parser.add_argument('--triplet', help='target triplet to pass to the toolchain')
+    parser.add_argument('--generator', help='CMake generator to use')
+    args = parser.parse_args()
+
+    common_options = []
+    if args.generator:
+        common_options += ['-G', args.generator]
+    toolchain_options = common_options + [f'-DCMAKE_TOOLCHAIN_FILE={TOOLCHAIN_FILE}']
+    if args.triplet:
+        toolchain_options.append(f'-DVCPKG_TARGET_TRIPLET={args.triplet}')
+    variants = [
+        ('no toolchain', common_options),
+        ('toolchain', toolchain_options + ['-DX_VCPKG_TRY_COMPILE_FAST_PATH=OFF']),
+        ('toolchain, fast path', toolchain_options + ['-DX_VCPKG_TRY_COMPILE_FAST_PATH=ON']),
+    ]
+
+    working_directory = tempfile.mkdtemp(prefix='vcpkg-benchmark-')
+    try:
+        project_directory = os.path.join(working_directory, 'project')
+        build_directory = os.path.join(working_directory, 'build')
+        os.mkdir(project_directory)
+        write_project(project_directory, args.checks)
+
+        times = {}
+        for _ in range(args.runs):
+            # interleave the variants, so that they share any drift of the machine
+            for name, options in variants:
+                elapsed_time = configure(project_directory, build_directory, options)
+                times[name] = min(times.get(name, elapsed_time), elapsed_time)
+    finally:
+        shutil.rmtree(working_directory, ignore_errors=True)
+
+    baseline_time = times['no toolchain']
+    print(f'Configure time of a project with {args.checks} checks (fastest of {args.runs} runs):')
+    for name, _ in variants:
+        overhead = (times[name] - baseline_time) * 1000 / args.checks
+        print(f'  {name:<22} {times[name]:7.2f} seconds  {overhead:6.2f} ms per check over no toolchain')
+
+
+if __name__ == "__main__":
+    main()
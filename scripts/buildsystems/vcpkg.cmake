@@ -38,6 +38,87 @@ endif()
 cmake_policy(PUSH)
 cmake_policy(SET CMP0054 NEW)
 
+#[===[.md:
+# z_vcpkg_add_installed_search_paths
+
+Adds `${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}` and its `debug` subdirectory
+to the search paths of the `find_*` commands, and sets `VCPKG_CMAKE_FIND_ROOT_PATH`.
+#]===]
+macro(z_vcpkg_add_installed_search_paths)
+    if(VCPKG_PREFER_SYSTEM_LIBS)
+        set(Z_VCPKG_PATH_LIST_OP APPEND)
+    else()
+        set(Z_VCPKG_PATH_LIST_OP PREPEND)
+    endif()
+
+    if(CMAKE_BUILD_TYPE MATCHES "^[Dd][Ee][Bb][Uu][Gg]$" OR NOT DEFINED CMAKE_BUILD_TYPE) #Debug build: Put Debug paths before Release paths.
+        list(${Z_VCPKG_PATH_LIST_OP} CMAKE_PREFIX_PATH
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug"
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}"
+        )
+        list(${Z_VCPKG_PATH_LIST_OP} CMAKE_LIBRARY_PATH
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug/lib/manual-link"
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/lib/manual-link"
+        )
+        list(${Z_VCPKG_PATH_LIST_OP} CMAKE_FIND_ROOT_PATH
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug"
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}"
+        )
+    else() #Release build: Put Release paths before Debug paths. Debug Paths are required so that CMake generates correct info in autogenerated target files.
+        list(${Z_VCPKG_PATH_LIST_OP} CMAKE_PREFIX_PATH
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}"
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug"
+        )
+        list(${Z_VCPKG_PATH_LIST_OP} CMAKE_LIBRARY_PATH
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/lib/manual-link"
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug/lib/manual-link"
+        )
+        list(${Z_VCPKG_PATH_LIST_OP} CMAKE_FIND_ROOT_PATH
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}"
+            "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug"
+        )
+    endif()
+
+    # If one CMAKE_FIND_ROOT_PATH_MODE_* variables is set to ONLY, to  make sure that ${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}
+    # and ${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug are searched, it is not sufficient to just add them to CMAKE_FIND_ROOT_PATH,
+    # as CMAKE_FIND_ROOT_PATH specify "one or more directories to be prepended to all other search directories", so to make sure that
+    # the libraries are searched as they are, it is necessary to add "/" to the CMAKE_PREFIX_PATH
+    if(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE STREQUAL "ONLY" OR
+       CMAKE_FIND_ROOT_PATH_MODE_LIBRARY STREQUAL "ONLY" OR
+       CMAKE_FIND_ROOT_PATH_MODE_PACKAGE STREQUAL "ONLY")
+       list(APPEND CMAKE_PREFIX_PATH "/")
+    endif()
+
+    set(VCPKG_CMAKE_FIND_ROOT_PATH "${CMAKE_FIND_ROOT_PATH}")
+endmacro()
+
+# Determine whether the toolchain is loaded during a try-compile configuration
+get_property(Z_VCPKG_CMAKE_IN_TRY_COMPILE GLOBAL PROPERTY IN_TRY_COMPILE)
+
+# The projects which try_compile() generates for source files only compile and link them;
+# they never call find_package() or install(). When the toolchain of the calling project
+# enabled it (see the end of this file), the results of its configuration are passed in,
+# and the toolchain only needs to set up the search paths.
+if(Z_VCPKG_CMAKE_IN_TRY_COMPILE AND Z_VCPKG_TRY_COMPILE_FAST_PATH
+    AND CMAKE_SOURCE_DIR MATCHES "/CMakeFiles/(CMakeTmp|CMakeScratch/TryCompile-[^/]+)$")
+    if(VCPKG_CHAINLOAD_TOOLCHAIN_FILE)
+        include("${VCPKG_CHAINLOAD_TOOLCHAIN_FILE}")
+    endif()
+    if(NOT VCPKG_TOOLCHAIN)
+        if(NOT DEFINED CMAKE_MAP_IMPORTED_CONFIG_MINSIZEREL)
+            set(CMAKE_MAP_IMPORTED_CONFIG_MINSIZEREL "MinSizeRel;Release;")
+        endif()
+        if(NOT DEFINED CMAKE_MAP_IMPORTED_CONFIG_RELWITHDEBINFO)
+            set(CMAKE_MAP_IMPORTED_CONFIG_RELWITHDEBINFO "RelWithDebInfo;Release;")
+        endif()
+        z_vcpkg_add_installed_search_paths()
+        list(APPEND CMAKE_PROGRAM_PATH ${Z_VCPKG_PROGRAM_PATHS})
+        set(VCPKG_TOOLCHAIN ON)
+    endif()
+    cmake_policy(POP)
+    return()
+endif()
+
 include(CMakeDependentOption)
 
 # VCPKG toolchain options.
@@ -113,6 +194,23 @@ if(VCPKG_MANIFEST_INSTALL)
     set(Z_VCPKG_UNUSED VCPKG_INSTALL_OPTIONS)
 endif()
 
+CMAKE_DEPENDENT_OPTION(X_VCPKG_MANIFEST_INSTALL_SKIP_UNCHANGED [[
+(experimental) Skip the manifest install when nothing that it depends on changed since the last successful install.
+]]
+    ON
+    "VCPKG_MANIFEST_INSTALL"
+    OFF)
+mark_as_advanced(X_VCPKG_MANIFEST_INSTALL_SKIP_UNCHANGED)
+
+option(X_VCPKG_FIND_PACKAGE_INDEX "(experimental) Resolve find_package() calls for installed config packages from an index of the installed tree, instead of searching for them." ON)
+mark_as_advanced(X_VCPKG_FIND_PACKAGE_INDEX)
+
+option(X_VCPKG_FIND_PACKAGE_TIMING "(experimental) Write the time taken by each find_package() call to vcpkg-find-package.log in the build directory." OFF)
+mark_as_advanced(X_VCPKG_FIND_PACKAGE_TIMING)
+
+option(X_VCPKG_TRY_COMPILE_FAST_PATH "(experimental) Pass the results of the toolchain configuration to the projects which try_compile() generates, so that the toolchain does not redo it for every check." ON)
+mark_as_advanced(X_VCPKG_TRY_COMPILE_FAST_PATH)
+
 # CMake helper utilities
 
 #[===[.md:
@@ -198,9 +296,6 @@ function(z_vcpkg_set_powershell_path)
 endfunction()
 
 
-# Determine whether the toolchain is loaded during a try-compile configuration
-get_property(Z_VCPKG_CMAKE_IN_TRY_COMPILE GLOBAL PROPERTY IN_TRY_COMPILE)
-
 if(CMAKE_VERSION VERSION_LESS "3.6.0")
     set(Z_VCPKG_CMAKE_EMULATE_TRY_COMPILE_PLATFORM_VARIABLES ON)
 else()
@@ -385,51 +480,7 @@ set(_VCPKG_INSTALLED_DIR "${VCPKG_INSTALLED_DIR}"
     CACHE PATH
     "The directory which contains the installed libraries for each triplet" FORCE)
 
-if(VCPKG_PREFER_SYSTEM_LIBS)
-    set(Z_VCPKG_PATH_LIST_OP APPEND)
-else()
-    set(Z_VCPKG_PATH_LIST_OP PREPEND)
-endif()
-
-if(CMAKE_BUILD_TYPE MATCHES "^[Dd][Ee][Bb][Uu][Gg]$" OR NOT DEFINED CMAKE_BUILD_TYPE) #Debug build: Put Debug paths before Release paths.
-    list(${Z_VCPKG_PATH_LIST_OP} CMAKE_PREFIX_PATH
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug"
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}"
-    )
-    list(${Z_VCPKG_PATH_LIST_OP} CMAKE_LIBRARY_PATH
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug/lib/manual-link"
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/lib/manual-link"
-    )
-    list(${Z_VCPKG_PATH_LIST_OP} CMAKE_FIND_ROOT_PATH
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug"
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}"
-    )
-else() #Release build: Put Release paths before Debug paths. Debug Paths are required so that CMake generates correct info in autogenerated target files.
-    list(${Z_VCPKG_PATH_LIST_OP} CMAKE_PREFIX_PATH
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}"
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug"
-    )
-    list(${Z_VCPKG_PATH_LIST_OP} CMAKE_LIBRARY_PATH
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/lib/manual-link"
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug/lib/manual-link"
-    )
-    list(${Z_VCPKG_PATH_LIST_OP} CMAKE_FIND_ROOT_PATH
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}"
-        "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug"
-    )
-endif()
-
-# If one CMAKE_FIND_ROOT_PATH_MODE_* variables is set to ONLY, to  make sure that ${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}
-# and ${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/debug are searched, it is not sufficient to just add them to CMAKE_FIND_ROOT_PATH,
-# as CMAKE_FIND_ROOT_PATH specify "one or more directories to be prepended to all other search directories", so to make sure that
-# the libraries are searched as they are, it is necessary to add "/" to the CMAKE_PREFIX_PATH
-if(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE STREQUAL "ONLY" OR
-   CMAKE_FIND_ROOT_PATH_MODE_LIBRARY STREQUAL "ONLY" OR
-   CMAKE_FIND_ROOT_PATH_MODE_PACKAGE STREQUAL "ONLY")
-   list(APPEND CMAKE_PREFIX_PATH "/")
-endif()
-
-set(VCPKG_CMAKE_FIND_ROOT_PATH "${CMAKE_FIND_ROOT_PATH}")
+z_vcpkg_add_installed_search_paths()
 
 # CMAKE_EXECUTABLE_SUFFIX is not yet defined
 if(CMAKE_HOST_SYSTEM_NAME STREQUAL "Windows")
@@ -440,6 +491,123 @@ else()
     set(Z_VCPKG_BOOTSTRAP_SCRIPT "${Z_VCPKG_ROOT_DIR}/bootstrap-vcpkg.sh")
 endif()
 
+#[===[.md:
+# z_vcpkg_get_root_head
+
+Gets the commit checked out in the vcpkg root, or an empty string,
+and places it in the variable `<out-var>`.
+The git metadata is read directly, since starting git costs as much as the install that it would save.
+#]===]
+function(z_vcpkg_get_root_head OUT_VAR)
+    set("${OUT_VAR}" "" PARENT_SCOPE)
+    set(git_dir "${Z_VCPKG_ROOT_DIR}/.git")
+    if(EXISTS "${git_dir}" AND NOT IS_DIRECTORY "${git_dir}")
+        # a worktree or submodule, where .git is a file pointing to the real git directory
+        file(READ "${git_dir}" git_file)
+        if(NOT git_file MATCHES "gitdir: ([^\r\n]*)")
+            return()
+        endif()
+        get_filename_component(git_dir "${CMAKE_MATCH_1}" ABSOLUTE BASE_DIR "${Z_VCPKG_ROOT_DIR}")
+    endif()
+    if(NOT EXISTS "${git_dir}/HEAD")
+        return()
+    endif()
+    set(common_dir "${git_dir}")
+    if(EXISTS "${git_dir}/commondir")
+        file(READ "${git_dir}/commondir" common_dir)
+        string(STRIP "${common_dir}" common_dir)
+        get_filename_component(common_dir "${common_dir}" ABSOLUTE BASE_DIR "${git_dir}")
+    endif()
+
+    file(READ "${git_dir}/HEAD" head)
+    string(STRIP "${head}" head)
+    if(head MATCHES "^ref: (.*)$")
+        set(ref "${CMAKE_MATCH_1}")
+        if(EXISTS "${common_dir}/${ref}")
+            file(READ "${common_dir}/${ref}" head)
+            string(STRIP "${head}" head)
+        elseif(EXISTS "${common_dir}/packed-refs")
+            file(STRINGS "${common_dir}/packed-refs" packed_refs REGEX " ${ref}$")
+            string(REGEX REPLACE " .*" "" head "${packed_refs}")
+        else()
+            set(head "")
+        endif()
+    endif()
+    set("${OUT_VAR}" "${head}" PARENT_SCOPE)
+endfunction()
+
+#[===[.md:
+# z_vcpkg_get_manifest_install_fingerprint
+
+Describes everything that the result of the manifest install depends on,
+and places the description in the variable `<out-var>`:
+the manifest and configuration files, the triplets, the overlays, the features, the options,
+the vcpkg tool and the commit of the vcpkg root.
+Overlay directories are described by the names and modification times of their files.
+The `ports`, `scripts` and `triplets` directories of the vcpkg root are described the same way,
+so that uncommitted changes to the root are noticed as well;
+since there are thousands of these files, only the hash of their description is recorded.
+#]===]
+function(z_vcpkg_get_manifest_install_fingerprint OUT_VAR)
+    set(fingerprint "")
+    foreach(manifest_file IN ITEMS vcpkg.json vcpkg-configuration.json)
+        set(manifest_hash "")
+        if(EXISTS "${VCPKG_MANIFEST_DIR}/${manifest_file}")
+            file(SHA256 "${VCPKG_MANIFEST_DIR}/${manifest_file}" manifest_hash)
+        endif()
+        string(APPEND fingerprint "${manifest_file}=${manifest_hash}\n")
+    endforeach()
+
+    z_vcpkg_get_root_head(root_head)
+    file(TIMESTAMP "${Z_VCPKG_EXECUTABLE}" executable_timestamp UTC)
+    string(APPEND fingerprint
+        "vcpkg-root=${Z_VCPKG_ROOT_DIR}@${root_head}\n"
+        "vcpkg-executable=${executable_timestamp}\n"
+        "triplet=${VCPKG_TARGET_TRIPLET}\n"
+        "host-triplet=${VCPKG_HOST_TRIPLET}\n"
+        "features=${VCPKG_MANIFEST_FEATURES}\n"
+        "no-default-features=${VCPKG_MANIFEST_NO_DEFAULT_FEATURES}\n"
+        "feature-flags=${Z_VCPKG_FEATURE_FLAGS};$ENV{VCPKG_FEATURE_FLAGS}\n"
+        "install-options=${VCPKG_INSTALL_OPTIONS}\n"
+        "binary-sources=$ENV{VCPKG_BINARY_SOURCES}\n"
+    )
+
+    file(GLOB_RECURSE root_files LIST_DIRECTORIES true
+        "${Z_VCPKG_ROOT_DIR}/ports/*"
+        "${Z_VCPKG_ROOT_DIR}/scripts/*"
+        "${Z_VCPKG_ROOT_DIR}/triplets/*"
+    )
+    list(SORT root_files)
+    set(root_description "")
+    foreach(root_file IN LISTS root_files)
+        file(TIMESTAMP "${root_file}" root_file_timestamp UTC)
+        string(APPEND root_description "${root_file}=${root_file_timestamp}\n")
+    endforeach()
+    string(SHA256 root_description_hash "${root_description}")
+    string(APPEND fingerprint "vcpkg-root-files=${root_description_hash}\n")
+
+    set(overlays "${VCPKG_OVERLAY_PORTS};${VCPKG_OVERLAY_TRIPLETS}")
+    foreach(env_var IN ITEMS VCPKG_OVERLAY_PORTS VCPKG_OVERLAY_TRIPLETS)
+        if(DEFINED ENV{${env_var}})
+            file(TO_CMAKE_PATH "$ENV{${env_var}}" env_overlays)
+            list(APPEND overlays ${env_overlays})
+        endif()
+    endforeach()
+    foreach(overlay IN LISTS overlays)
+        if(NOT overlay STREQUAL "")
+            get_filename_component(overlay "${overlay}" ABSOLUTE BASE_DIR "${VCPKG_MANIFEST_DIR}")
+            string(APPEND fingerprint "overlay=${overlay}\n")
+            file(GLOB_RECURSE overlay_files "${overlay}/*")
+            list(SORT overlay_files)
+            foreach(overlay_file IN LISTS overlay_files)
+                file(TIMESTAMP "${overlay_file}" overlay_file_timestamp UTC)
+                string(APPEND fingerprint "${overlay_file}=${overlay_file_timestamp}\n")
+            endforeach()
+        endif()
+    endforeach()
+    set("${OUT_VAR}" "${fingerprint}" PARENT_SCOPE)
+endfunction()
+
 if(VCPKG_MANIFEST_MODE AND VCPKG_MANIFEST_INSTALL AND NOT Z_VCPKG_CMAKE_IN_TRY_COMPILE AND NOT Z_VCPKG_HAS_FATAL_ERROR)
     if(NOT EXISTS "${Z_VCPKG_EXECUTABLE}" AND NOT Z_VCPKG_HAS_FATAL_ERROR)
         message(STATUS "Bootstrapping vcpkg before install")
@@ -460,8 +628,6 @@ if(VCPKG_MANIFEST_MODE AND VCPKG_MANIFEST_INSTALL AND NOT Z_VCPKG_CMAKE_IN_TRY_C
     endif()
 
     if(NOT Z_VCPKG_HAS_FATAL_ERROR)
-        message(STATUS "Running vcpkg install")
-
         set(Z_VCPKG_ADDITIONAL_MANIFEST_PARAMS)
 
         if(DEFINED VCPKG_HOST_TRIPLET AND NOT VCPKG_HOST_TRIPLET STREQUAL "")
@@ -498,6 +664,24 @@ if(VCPKG_MANIFEST_MODE AND VCPKG_MANIFEST_INSTALL AND NOT Z_VCPKG_CMAKE_IN_TRY_C
             set(Z_VCPKG_MANIFEST_INSTALL_ECHO_PARAMS)
         endif()
 
+        set(Z_VCPKG_MANIFEST_INSTALL_FINGERPRINT_FILE "${_VCPKG_INSTALLED_DIR}/.cmakestamp-fingerprint")
+        z_vcpkg_get_manifest_install_fingerprint(Z_VCPKG_MANIFEST_INSTALL_FINGERPRINT)
+        set(Z_VCPKG_MANIFEST_INSTALL_PREVIOUS_FINGERPRINT "")
+        if(X_VCPKG_MANIFEST_INSTALL_SKIP_UNCHANGED
+                AND EXISTS "${Z_VCPKG_MANIFEST_INSTALL_FINGERPRINT_FILE}"
+                AND EXISTS "${_VCPKG_INSTALLED_DIR}/vcpkg/status")
+            file(READ "${Z_VCPKG_MANIFEST_INSTALL_FINGERPRINT_FILE}" Z_VCPKG_MANIFEST_INSTALL_PREVIOUS_FINGERPRINT)
+        endif()
+    endif()
+
+    if(NOT Z_VCPKG_HAS_FATAL_ERROR AND Z_VCPKG_MANIFEST_INSTALL_FINGERPRINT STREQUAL Z_VCPKG_MANIFEST_INSTALL_PREVIOUS_FINGERPRINT)
+        message(STATUS "Running vcpkg install - skipped, nothing changed since the last install")
+        set(Z_VCPKG_MANIFEST_INSTALL_RESULT 0)
+    elseif(NOT Z_VCPKG_HAS_FATAL_ERROR)
+        message(STATUS "Running vcpkg install")
+        # an interrupted install must not leave the previous fingerprint behind
+        file(REMOVE "${Z_VCPKG_MANIFEST_INSTALL_FINGERPRINT_FILE}")
+
         execute_process(
             COMMAND "${Z_VCPKG_EXECUTABLE}" install
                 --triplet "${VCPKG_TARGET_TRIPLET}"
@@ -522,27 +706,146 @@ if(VCPKG_MANIFEST_MODE AND VCPKG_MANIFEST_INSTALL AND NOT Z_VCPKG_CMAKE_IN_TRY_C
 
             # file(TOUCH) added in CMake 3.12
             file(WRITE "${_VCPKG_INSTALLED_DIR}/.cmakestamp" "")
-            set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS
-                "${VCPKG_MANIFEST_DIR}/vcpkg.json"
-                "${_VCPKG_INSTALLED_DIR}/.cmakestamp")
-            if(EXISTS "${VCPKG_MANIFEST_DIR}/vcpkg-configuration.json")
-                set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS
-                    "${VCPKG_MANIFEST_DIR}/vcpkg-configuration.json")
-            endif()
+            file(WRITE "${Z_VCPKG_MANIFEST_INSTALL_FINGERPRINT_FILE}" "${Z_VCPKG_MANIFEST_INSTALL_FINGERPRINT}")
         else()
             message(STATUS "Running vcpkg install - failed")
             z_vcpkg_add_fatal_error("vcpkg install failed. See logs for more information: ${Z_VCPKG_MANIFEST_INSTALL_LOGFILE}")
         endif()
     endif()
+
+    if(NOT Z_VCPKG_HAS_FATAL_ERROR AND Z_VCPKG_MANIFEST_INSTALL_RESULT EQUAL 0)
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS
+            "${VCPKG_MANIFEST_DIR}/vcpkg.json"
+            "${_VCPKG_INSTALLED_DIR}/.cmakestamp")
+        if(EXISTS "${VCPKG_MANIFEST_DIR}/vcpkg-configuration.json")
+            set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS
+                "${VCPKG_MANIFEST_DIR}/vcpkg-configuration.json")
+        endif()
+    endif()
 endif()
 
-list(APPEND CMAKE_PROGRAM_PATH "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/tools")
+#[===[.md:
+# z_vcpkg_update_find_package_index
+
+Writes an index of the installed tree of the target triplet to `Z_VCPKG_FIND_PACKAGE_INDEX_PATH` in the build directory,
+unless it was written for the same installed tree after the last change to that tree.
+The installed tree itself is never written, since it may be shared or read-only.
+
+The index maps the lowercase name of each package whose config file CMake would find in the installed tree
+to the directory of that config file, and lists the packages which provide a `vcpkg-cmake-wrapper.cmake`.
+It only contains packages found by the default search in exactly one directory;
+everything else is left to the normal search of `find_package()`.
+#]===]
+function(z_vcpkg_update_find_package_index)
+    set(prefix "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}")
+    set(index_file "${Z_VCPKG_FIND_PACKAGE_INDEX_PATH}")
+    set(status_file "${_VCPKG_INSTALLED_DIR}/vcpkg/status")
+    set(index_header "# Generated by vcpkg.cmake from ${prefix}; do not edit.")
+    if(NOT EXISTS "${status_file}" OR NOT IS_DIRECTORY "${prefix}/share")
+        file(REMOVE "${index_file}")
+        return()
+    endif()
+    if(EXISTS "${index_file}" AND NOT "${status_file}" IS_NEWER_THAN "${index_file}")
+        file(STRINGS "${index_file}" index_first_line LIMIT_COUNT 1)
+        if(index_first_line STREQUAL index_header)
+            return()
+        endif()
+    endif()
+
+    # the locations of config files below a prefix which the search of find_package() looks into
+    set(patterns
+        share/*/*onfig.cmake share/*/cmake/*onfig.cmake share/*/CMake/*onfig.cmake share/cmake/*/*onfig.cmake
+        lib/cmake/*/*onfig.cmake lib/*/*onfig.cmake lib/*/cmake/*onfig.cmake lib/*/CMake/*onfig.cmake
+    )
+    set(keys "")
+    foreach(config_prefix IN ITEMS "${prefix}" "${prefix}/debug")
+        set(globs "")
+        foreach(pattern IN LISTS patterns)
+            list(APPEND globs "${config_prefix}/${pattern}")
+        endforeach()
+        file(GLOB config_files RELATIVE "${prefix}" ${globs})
+        foreach(config_file IN LISTS config_files)
+            get_filename_component(config_name "${config_file}" NAME)
+            get_filename_component(config_dir "${config_file}" DIRECTORY)
+            if(config_name MATCHES "^(.+)Config\\.cmake$")
+                set(package_name "${CMAKE_MATCH_1}")
+                string(TOLOWER "${package_name}" key)
+            elseif(config_name MATCHES "^(.+)-config\\.cmake$")
+                set(package_name "${CMAKE_MATCH_1}")
+                string(TOLOWER "${package_name}" key)
+                if(NOT key STREQUAL package_name)
+                    continue()
+                endif()
+                # found for any case of the name
+                set(package_name "")
+            else()
+                continue()
+            endif()
+
+            # find_package(<name>) only looks into directories whose name starts with <name>
+            if(config_file MATCHES "^(debug/)?(share|lib)/cmake/([^/]+)/")
+                set(package_dir "${CMAKE_MATCH_3}")
+            elseif(config_file MATCHES "^(debug/)?(share|lib)/([^/]+)/")
+                set(package_dir "${CMAKE_MATCH_3}")
+            endif()
+            string(TOLOWER "${package_dir}" package_dir)
+            string(FIND "${package_dir}" "${key}" package_dir_position)
+            if(NOT package_dir_position EQUAL "0")
+                continue()
+            endif()
+
+            if(NOT DEFINED "dir_${key}")
+                list(APPEND keys "${key}")
+                set("dir_${key}" "${config_dir}")
+                set("name_${key}" "${package_name}")
+            elseif(NOT dir_${key} STREQUAL config_dir)
+                set("dir_${key}" "")
+            elseif(package_name STREQUAL "")
+                set("name_${key}" "")
+            endif()
+        endforeach()
+    endforeach()
+
+    set(index "${index_header}\n")
+    file(GLOB wrappers RELATIVE "${prefix}/share" "${prefix}/share/*/vcpkg-cmake-wrapper.cmake")
+    foreach(wrapper IN LISTS wrappers)
+        get_filename_component(wrapper "${wrapper}" DIRECTORY)
+        string(APPEND index "set(\"Z_VCPKG_FIND_PACKAGE_INDEX_WRAPPER_${wrapper}\" ON)\n")
+    endforeach()
+    list(SORT keys)
+    foreach(key IN LISTS keys)
+        if(NOT dir_${key} STREQUAL "")
+            string(APPEND index
+                "set(\"Z_VCPKG_FIND_PACKAGE_INDEX_DIR_${key}\" \"${dir_${key}}\")\n"
+                "set(\"Z_VCPKG_FIND_PACKAGE_INDEX_NAME_${key}\" \"${name_${key}}\")\n"
+            )
+        endif()
+    endforeach()
+    string(RANDOM LENGTH 8 suffix)
+    file(WRITE "${index_file}.${suffix}.tmp" "${index}")
+    file(RENAME "${index_file}.${suffix}.tmp" "${index_file}")
+endfunction()
+
+set(Z_VCPKG_FIND_PACKAGE_INDEX_LOADED OFF)
+# try_compile() projects have their own build directory without an index, and use the normal search.
+if(X_VCPKG_FIND_PACKAGE_INDEX AND NOT VCPKG_PREFER_SYSTEM_LIBS AND NOT Z_VCPKG_HAS_FATAL_ERROR AND NOT Z_VCPKG_CMAKE_IN_TRY_COMPILE)
+    set(Z_VCPKG_FIND_PACKAGE_INDEX_PATH "${CMAKE_BINARY_DIR}/vcpkg-find-package-index-${VCPKG_TARGET_TRIPLET}.cmake")
+    z_vcpkg_update_find_package_index()
+    include("${Z_VCPKG_FIND_PACKAGE_INDEX_PATH}"
+        OPTIONAL RESULT_VARIABLE Z_VCPKG_FIND_PACKAGE_INDEX_FILE)
+    if(Z_VCPKG_FIND_PACKAGE_INDEX_FILE)
+        set(Z_VCPKG_FIND_PACKAGE_INDEX_LOADED ON)
+    endif()
+endif()
+
+set(Z_VCPKG_PROGRAM_PATHS "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/tools")
 file(GLOB Z_VCPKG_TOOLS_DIRS "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/tools/*")
 foreach(Z_VCPKG_TOOLS_DIR IN LISTS Z_VCPKG_TOOLS_DIRS)
     if(IS_DIRECTORY "${Z_VCPKG_TOOLS_DIR}")
-        list(APPEND CMAKE_PROGRAM_PATH "${Z_VCPKG_TOOLS_DIR}")
+        list(APPEND Z_VCPKG_PROGRAM_PATHS "${Z_VCPKG_TOOLS_DIR}")
     endif()
 endforeach()
+list(APPEND CMAKE_PROGRAM_PATH ${Z_VCPKG_PROGRAM_PATHS})
 
 function(add_executable)
     z_vcpkg_function_arguments(ARGS)
@@ -709,6 +1012,143 @@ if(X_VCPKG_APPLOCAL_DEPS_INSTALL)
     endfunction()
 endif()
 
+#[===[.md:
+# z_vcpkg_find_package_index_lookup
+
+Sets `<out-var>` to the directory of the config file of `<package-name>` in the installed tree
+if the index written by `z_vcpkg_update_find_package_index()` knows it
+and `find_package(<package-name> <arg>...)` would find that config file with its default search,
+or to an empty string otherwise.
+#]===]
+function(z_vcpkg_find_package_index_lookup OUT_VAR PACKAGE_NAME)
+    set("${OUT_VAR}" "" PARENT_SCOPE)
+    string(TOLOWER "${PACKAGE_NAME}" key)
+    if(NOT DEFINED "Z_VCPKG_FIND_PACKAGE_INDEX_DIR_${key}")
+        return()
+    endif()
+    set(name "${Z_VCPKG_FIND_PACKAGE_INDEX_NAME_${key}}")
+    if(NOT name STREQUAL "" AND NOT name STREQUAL PACKAGE_NAME AND NOT CMAKE_HOST_WIN32 AND NOT CMAKE_HOST_APPLE)
+        # only <name>Config.cmake exists, and the file system is case-sensitive
+        return()
+    endif()
+
+    set(config_mode OFF)
+    foreach(arg IN LISTS ARGN)
+        if(arg STREQUAL "CONFIG" OR arg STREQUAL "NO_MODULE")
+            set(config_mode ON)
+        elseif(arg MATCHES "^(MODULE|NAMES|CONFIGS|HINTS|PATHS|PATH_SUFFIXES|NO_DEFAULT_PATH|NO_CMAKE_PATH|NO_CMAKE_FIND_ROOT_PATH|ONLY_CMAKE_FIND_ROOT_PATH)$")
+            # the call does not use the default search for config files
+            return()
+        endif()
+    endforeach()
+    if(NOT config_mode)
+        # a find module takes precedence, and it may give <name>_DIR a meaning of its own
+        foreach(module_dir IN LISTS CMAKE_MODULE_PATH ITEMS "${CMAKE_ROOT}/Modules")
+            if(EXISTS "${module_dir}/Find${PACKAGE_NAME}.cmake")
+                return()
+            endif()
+        endforeach()
+    endif()
+    set("${OUT_VAR}" "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/${Z_VCPKG_FIND_PACKAGE_INDEX_DIR_${key}}" PARENT_SCOPE)
+endfunction()
+
+#[===[.md:
+# z_vcpkg_find_package_timing
+
+When `X_VCPKG_FIND_PACKAGE_TIMING` is `ON`, records how long each `find_package()` call takes,
+and reports the total at the end of the configure step:
+
+```cmake
+z_vcpkg_find_package_timing(BEGIN)
+z_vcpkg_find_package_timing(SOURCE <index|wrapper|search>)
+z_vcpkg_find_package_timing(END <package-name>)
+z_vcpkg_find_package_timing(REPORT)
+```
+
+Calls nest, since config files and wrappers call `find_package()` themselves;
+the total only counts the outermost calls.
+`REPORT` writes every call to `${CMAKE_BINARY_DIR}/vcpkg-find-package.log`, slowest first.
+Timing requires CMake 3.23, which added microseconds to `string(TIMESTAMP)`.
+#]===]
+function(z_vcpkg_find_package_timing MODE)
+    if(NOT X_VCPKG_FIND_PACKAGE_TIMING OR CMAKE_VERSION VERSION_LESS "3.23" OR Z_VCPKG_CMAKE_IN_TRY_COMPILE)
+        return()
+    endif()
+    string(TIMESTAMP now "%s%f" UTC)
+    get_property(stack GLOBAL PROPERTY Z_VCPKG_FIND_PACKAGE_TIMING_STACK)
+    if(MODE STREQUAL "BEGIN")
+        list(APPEND stack "${now}:search")
+    elseif(MODE STREQUAL "SOURCE")
+        list(LENGTH stack depth)
+        if(depth EQUAL "0")
+            return()
+        endif()
+        list(GET stack -1 entry)
+        list(REMOVE_AT stack -1)
+        string(REGEX REPLACE ":.*" ":${ARGV1}" entry "${entry}")
+        list(APPEND stack "${entry}")
+    elseif(MODE STREQUAL "END")
+        list(LENGTH stack depth)
+        if(depth EQUAL "0")
+            return()
+        endif()
+        list(GET stack -1 entry)
+        list(REMOVE_AT stack -1)
+        string(REPLACE ":" ";" entry "${entry}")
+        list(GET entry 0 start)
+        list(GET entry 1 source)
+        math(EXPR depth "${depth} - 1")
+        math(EXPR duration "${now} - ${start}")
+        set_property(GLOBAL APPEND PROPERTY Z_VCPKG_FIND_PACKAGE_TIMING_RECORDS "${duration}:${depth}:${source}:${ARGV1}")
+    elseif(MODE STREQUAL "REPORT")
+        get_property(records GLOBAL PROPERTY Z_VCPKG_FIND_PACKAGE_TIMING_RECORDS)
+        set(total 0)
+        set(calls 0)
+        set(index_hits 0)
+        set(lines "")
+        foreach(record IN LISTS records)
+            string(REPLACE ":" ";" record "${record}")
+            list(GET record 0 duration)
+            list(GET record 1 depth)
+            list(GET record 2 source)
+            list(GET record 3 package_name)
+            math(EXPR calls "${calls} + 1")
+            if(depth EQUAL "0")
+                math(EXPR total "${total} + ${duration}")
+            endif()
+            if(source STREQUAL "index")
+                math(EXPR index_hits "${index_hits} + 1")
+            endif()
+            # zero-padded, so that sorting the lines sorts by duration
+            string(LENGTH "${duration}" length)
+            math(EXPR length "12 - ${length}")
+            string(REPEAT "0" "${length}" padding)
+            list(APPEND lines "${padding}${duration} us  ${package_name} (${source}, depth ${depth})")
+        endforeach()
+        list(SORT lines ORDER DESCENDING)
+        set(log "")
+        foreach(line IN LISTS lines)
+            string(REGEX REPLACE "^0+([0-9])" "\\1" line "${line}")
+            string(APPEND log "${line}\n")
+        endforeach()
+        file(WRITE "${CMAKE_BINARY_DIR}/vcpkg-find-package.log" "${log}")
+        math(EXPR total "${total} / 1000")
+        message(STATUS "vcpkg: ${calls} find_package calls took ${total} ms; ${index_hits} resolved from the installed package index. See ${CMAKE_BINARY_DIR}/vcpkg-find-package.log")
+        return()
+    else()
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed invalid mode: ${MODE}")
+    endif()
+    set_property(GLOBAL PROPERTY Z_VCPKG_FIND_PACKAGE_TIMING_STACK "${stack}")
+endfunction()
+
+if(X_VCPKG_FIND_PACKAGE_TIMING AND NOT CMAKE_VERSION VERSION_LESS "3.23" AND NOT Z_VCPKG_CMAKE_IN_TRY_COMPILE)
+    get_property(Z_VCPKG_FIND_PACKAGE_TIMING_REPORT_DEFERRED GLOBAL PROPERTY Z_VCPKG_FIND_PACKAGE_TIMING_REPORT_DEFERRED)
+    if(NOT Z_VCPKG_FIND_PACKAGE_TIMING_REPORT_DEFERRED)
+        cmake_language(DEFER DIRECTORY "${CMAKE_SOURCE_DIR}" CALL z_vcpkg_find_package_timing REPORT)
+        set_property(GLOBAL PROPERTY Z_VCPKG_FIND_PACKAGE_TIMING_REPORT_DEFERRED ON)
+    endif()
+endif()
+
 if(NOT DEFINED VCPKG_OVERRIDE_FIND_PACKAGE_NAME)
     set(VCPKG_OVERRIDE_FIND_PACKAGE_NAME find_package)
 endif()
@@ -716,6 +1156,7 @@ endif()
 # this is fine for `find_package`, since there are no usecases for `;` in arguments,
 # so perfect forwarding is not important
 macro("${VCPKG_OVERRIDE_FIND_PACKAGE_NAME}" z_vcpkg_find_package_package_name)
+    z_vcpkg_find_package_timing(BEGIN)
     set(z_vcpkg_find_package_package_name "${z_vcpkg_find_package_package_name}")
     set(z_vcpkg_find_package_ARGN "${ARGN}")
     set(z_vcpkg_find_package_backup_vars)
@@ -739,7 +1180,17 @@ macro("${VCPKG_OVERRIDE_FIND_PACKAGE_NAME}" z_vcpkg_find_package_package_name)
     set(z_vcpkg_find_package_vcpkg_cmake_wrapper_path
         "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/share/${z_vcpkg_find_package_lowercase_package_name}/vcpkg-cmake-wrapper.cmake")
 
-    if(EXISTS "${z_vcpkg_find_package_vcpkg_cmake_wrapper_path}")
+    if(Z_VCPKG_FIND_PACKAGE_INDEX_LOADED)
+        set(z_vcpkg_find_package_has_vcpkg_cmake_wrapper
+            "${Z_VCPKG_FIND_PACKAGE_INDEX_WRAPPER_${z_vcpkg_find_package_lowercase_package_name}}")
+    elseif(EXISTS "${z_vcpkg_find_package_vcpkg_cmake_wrapper_path}")
+        set(z_vcpkg_find_package_has_vcpkg_cmake_wrapper ON)
+    else()
+        set(z_vcpkg_find_package_has_vcpkg_cmake_wrapper OFF)
+    endif()
+
+    if(z_vcpkg_find_package_has_vcpkg_cmake_wrapper)
+        z_vcpkg_find_package_timing(SOURCE wrapper)
         list(APPEND z_vcpkg_find_package_backup_vars "ARGS")
         if(DEFINED ARGS)
             set(z_vcpkg_find_package_backup_ARGS "${ARGS}")
@@ -794,6 +1245,16 @@ macro("${VCPKG_OVERRIDE_FIND_PACKAGE_NAME}" z_vcpkg_find_package_package_name)
     elseif("${z_vcpkg_find_package_lowercase_package_name}" STREQUAL "grpc" AND EXISTS "${_VCPKG_INSTALLED_DIR}/${VCPKG_TARGET_TRIPLET}/share/grpc")
         _find_package(gRPC ${z_vcpkg_find_package_ARGN})
     else()
+        if(Z_VCPKG_FIND_PACKAGE_INDEX_LOADED AND NOT DEFINED "${z_vcpkg_find_package_package_name}_DIR")
+            z_vcpkg_find_package_index_lookup(z_vcpkg_find_package_index_dir
+                "${z_vcpkg_find_package_package_name}" ${z_vcpkg_find_package_ARGN})
+            if(NOT z_vcpkg_find_package_index_dir STREQUAL "")
+                # find_package() tries <name>_DIR before it searches, and it would cache the same value
+                set("${z_vcpkg_find_package_package_name}_DIR" "${z_vcpkg_find_package_index_dir}" CACHE PATH
+                    "The directory containing a CMake configuration file for ${z_vcpkg_find_package_package_name}.")
+                z_vcpkg_find_package_timing(SOURCE index)
+            endif()
+        endif()
         _find_package("${z_vcpkg_find_package_package_name}" ${z_vcpkg_find_package_ARGN})
     endif()
 
@@ -804,6 +1265,7 @@ macro("${VCPKG_OVERRIDE_FIND_PACKAGE_NAME}" z_vcpkg_find_package_package_name)
             set("${z_vcpkg_find_package_backup_var}")
         endif()
     endforeach()
+    z_vcpkg_find_package_timing(END "${z_vcpkg_find_package_package_name}")
 endmacro()
 
 set(VCPKG_TOOLCHAIN ON)
@@ -833,6 +1295,18 @@ if(NOT Z_VCPKG_CMAKE_IN_TRY_COMPILE)
             VCPKG_CHAINLOAD_TOOLCHAIN_FILE
             Z_VCPKG_ROOT_DIR
         )
+        # The fast path skips the add_executable and add_library overrides,
+        # which matter for Visual Studio projects and for applocal deployment on Windows.
+        if(X_VCPKG_TRY_COMPILE_FAST_PATH AND NOT CMAKE_GENERATOR MATCHES "^Visual Studio"
+            AND NOT (VCPKG_APPLOCAL_DEPS AND Z_VCPKG_TARGET_TRIPLET_PLAT MATCHES "windows|uwp"))
+            set(Z_VCPKG_TRY_COMPILE_FAST_PATH ON)
+            list(APPEND CMAKE_TRY_COMPILE_PLATFORM_VARIABLES
+                Z_VCPKG_TRY_COMPILE_FAST_PATH
+                _VCPKG_INSTALLED_DIR
+                VCPKG_PREFER_SYSTEM_LIBS
+                Z_VCPKG_PROGRAM_PATHS
+            )
+        endif()
     endif()
 endif()
 
@@ -49,6 +49,10 @@ vcpkg_execute_required_process(
 )
 ```
 
+The MSYS2 root is assembled once for each list of packages, in `${DOWNLOADS}/tools/msys2/<hash of the package list>`,
+and reused by all later calls which resolve to the same packages in the same order.
+To assemble it, the missing packages are downloaded concurrently, and all packages are unpacked in parallel.
+
 ## Examples
 
 * [ffmpeg](https://github.com/Microsoft/vcpkg/blob/master/ports/ffmpeg/portfile.cmake)
@@ -68,10 +72,12 @@ set(Z_VCPKG_ACQUIRE_MSYS_MIRRORS
     "https://mirrors.sjtug.sjtu.edu.cn/msys2/"
 )
 
-function(z_vcpkg_acquire_msys_download_package out_archive)
+# Sets out_entry to the package's entry for z_vcpkg_prefetch_downloads_fetch:
+# its SHA512, the file name in the downloads directory and all URLs to try, separated by tabs.
+function(z_vcpkg_acquire_msys_download_entry out_entry)
     cmake_parse_arguments(PARSE_ARGV 1 "arg" "" "URL;SHA512;FILENAME" "")
     if(DEFINED arg_UNPARSED_ARGUMENTS)
-        message(FATAL_ERROR "internal error: z_vcpkg_acquire_msys_download_package passed extra args: ${arg_UNPARSED_ARGUMENTS}")
+        message(FATAL_ERROR "internal error: z_vcpkg_acquire_msys_download_entry passed extra args: ${arg_UNPARSED_ARGUMENTS}")
     endif()
 
     set(all_urls "${arg_URL}")
@@ -81,18 +87,13 @@ function(z_vcpkg_acquire_msys_download_package out_archive)
         list(APPEND all_urls "${mirror_url}")
     endforeach()
 
-    vcpkg_download_distfile(msys_archive
-        URLS ${all_urls}
-        SHA512 "${arg_SHA512}"
-        FILENAME "msys-${arg_FILENAME}"
-        QUIET
-    )
-    set("${out_archive}" "${msys_archive}" PARENT_SCOPE)
+    list(REMOVE_DUPLICATES all_urls)
+    list(JOIN all_urls "\t" all_urls)
+    set("${out_entry}" "${arg_SHA512}\tmsys-${arg_FILENAME}\t${all_urls}" PARENT_SCOPE)
 endfunction()
 
 # writes to the following variables in parent scope:
-#   - Z_VCPKG_MSYS_ARCHIVES
-#   - Z_VCPKG_MSYS_TOTAL_HASH
+#   - Z_VCPKG_MSYS_DOWNLOADS
 #   - Z_VCPKG_MSYS_PACKAGES
 function(z_vcpkg_acquire_msys_declare_package)
     cmake_parse_arguments(PARSE_ARGV 0 arg "" "NAME;URL;SHA512" "DEPS")
@@ -120,19 +121,84 @@ function(z_vcpkg_acquire_msys_declare_package)
         list(APPEND Z_VCPKG_MSYS_PACKAGES ${arg_DEPS})
         set(Z_VCPKG_MSYS_PACKAGES "${Z_VCPKG_MSYS_PACKAGES}" PARENT_SCOPE)
 
-        z_vcpkg_acquire_msys_download_package(archive
+        z_vcpkg_acquire_msys_download_entry(entry
             URL "${arg_URL}"
             SHA512 "${arg_SHA512}"
             FILENAME "${filename}"
         )
 
-        list(APPEND Z_VCPKG_MSYS_ARCHIVES "${archive}")
-        set(Z_VCPKG_MSYS_ARCHIVES "${Z_VCPKG_MSYS_ARCHIVES}" PARENT_SCOPE)
-        string(APPEND Z_VCPKG_MSYS_TOTAL_HASH "${arg_SHA512}")
-        set(Z_VCPKG_MSYS_TOTAL_HASH "${Z_VCPKG_MSYS_TOTAL_HASH}" PARENT_SCOPE)
+        list(APPEND Z_VCPKG_MSYS_DOWNLOADS "${entry}")
+        set(Z_VCPKG_MSYS_DOWNLOADS "${Z_VCPKG_MSYS_DOWNLOADS}" PARENT_SCOPE)
     endif()
 endfunction()
 
+# Downloads the given packages and unpacks them into root, in parallel.
+# When two packages contain the same file, the one given later wins, as if they were unpacked one after another.
+function(z_vcpkg_acquire_msys_assemble_root root)
+    z_vcpkg_prefetch_downloads_fetch(${ARGN})
+
+    set(archives "")
+    foreach(entry IN LISTS ARGN)
+        string(REPLACE "\t" ";" fields "${entry}")
+        list(POP_FRONT fields sha512 filename)
+        # the files are usually present by now, so this only verifies them
+        vcpkg_download_distfile(archive
+            URLS ${fields}
+            SHA512 "${sha512}"
+            FILENAME "${filename}"
+            QUIET
+        )
+        list(APPEND archives "${archive}")
+    endforeach()
+
+    file(REMOVE_RECURSE "${root}.tmp" "${root}.unpack")
+    file(MAKE_DIRECTORY "${root}.tmp/tmp")
+    set(jobs 4)
+    if(VCPKG_CONCURRENCY GREATER "0")
+        set(jobs "${VCPKG_CONCURRENCY}")
+    endif()
+    list(LENGTH archives archive_count)
+    message(STATUS "Unpacking ${archive_count} msys packages")
+    z_vcpkg_timing_begin(extract)
+    set(index 0)
+    while(index LESS archive_count)
+        set(commands "")
+        set(batch "")
+        set(batch_count 0)
+        while(index LESS archive_count AND batch_count LESS jobs)
+            list(GET archives "${index}" archive)
+            file(MAKE_DIRECTORY "${root}.unpack/${index}")
+            # The archives are unpacked concurrently as the stages of one pipeline; they do not write to stdout.
+            list(APPEND commands COMMAND "${CMAKE_COMMAND}" -E chdir "${root}.unpack/${index}"
+                "${CMAKE_COMMAND}" -E tar xzf "${archive}"
+            )
+            list(APPEND batch "${archive}")
+            math(EXPR index "${index} + 1")
+            math(EXPR batch_count "${batch_count} + 1")
+        endwhile()
+        vcpkg_execute_in_download_mode(
+            ${commands}
+            OUTPUT_QUIET
+            ERROR_VARIABLE error
+            RESULTS_VARIABLE results
+        )
+        foreach(archive result IN ZIP_LISTS batch results)
+            if(NOT result EQUAL "0")
+                message(FATAL_ERROR "Unpacking ${archive} failed:\n${error}")
+            endif()
+        endforeach()
+    endwhile()
+
+    set(index 0)
+    while(index LESS archive_count)
+        z_vcpkg_move_directory_contents(SOURCE "${root}.unpack/${index}" DESTINATION "${root}.tmp")
+        math(EXPR index "${index} + 1")
+    endwhile()
+    file(REMOVE_RECURSE "${root}.unpack")
+    file(RENAME "${root}.tmp" "${root}")
+    z_vcpkg_timing_end(extract "${CMAKE_CURRENT_FUNCTION}")
+endfunction()
+
 function(vcpkg_acquire_msys out_msys_root)
     cmake_parse_arguments(PARSE_ARGV 1 "arg"
         "NO_DEFAULT_PACKAGES;Z_ALL_PACKAGES"
@@ -144,8 +210,7 @@ function(vcpkg_acquire_msys out_msys_root)
         message(WARNING "vcpkg_acquire_msys was passed extra arguments: ${arg_UNPARSED_ARGUMENTS}")
     endif()
 
-    set(Z_VCPKG_MSYS_TOTAL_HASH)
-    set(Z_VCPKG_MSYS_ARCHIVES)
+    set(Z_VCPKG_MSYS_DOWNLOADS "")
 
     set(Z_VCPKG_MSYS_PACKAGES "${arg_PACKAGES}")
 
@@ -171,13 +236,12 @@ function(vcpkg_acquire_msys out_msys_root)
             list(GET arg_DIRECT_PACKAGES "${sha512_index}" sha512)
 
             get_filename_component(filename "${url}" NAME)
-            z_vcpkg_acquire_msys_download_package(archive
+            z_vcpkg_acquire_msys_download_entry(entry
                 URL "${url}"
                 SHA512 "${sha512}"
                 FILENAME "${filename}"
             )
-            list(APPEND Z_VCPKG_MSYS_ARCHIVES "${archive}")
-            string(APPEND Z_VCPKG_MSYS_TOTAL_HASH "${sha512}")
+            list(APPEND Z_VCPKG_MSYS_DOWNLOADS "${entry}")
         endforeach()
     endif()
 
@@ -545,23 +609,32 @@ function(vcpkg_acquire_msys out_msys_root)
 This can be resolved by explicitly passing URL/SHA pairs to DIRECT_PACKAGES.")
     endif()
 
-    string(SHA512 total_hash "${Z_VCPKG_MSYS_TOTAL_HASH}")
+    # Later packages overwrite the files of earlier ones when the root is assembled,
+    # so the root depends on the order of the packages as well as on the set of packages.
+    set(package_hashes "")
+    foreach(entry IN LISTS Z_VCPKG_MSYS_DOWNLOADS)
+        string(REGEX MATCH "^[^\t]*" package_hash "${entry}")
+        list(APPEND package_hashes "${package_hash}")
+    endforeach()
+    string(SHA512 total_hash "${package_hashes}")
     string(SUBSTRING "${total_hash}" 0 16 total_hash)
     set(path_to_root "${DOWNLOADS}/tools/msys2/${total_hash}")
-    if(NOT EXISTS "${path_to_root}")
-        file(REMOVE_RECURSE "${path_to_root}.tmp")
-        file(MAKE_DIRECTORY "${path_to_root}.tmp/tmp")
-        set(index 0)
-        foreach(archive IN LISTS Z_VCPKG_MSYS_ARCHIVES)
-            vcpkg_execute_required_process(
-                ALLOW_IN_DOWNLOAD_MODE
-                COMMAND "${CMAKE_COMMAND}" -E tar xzf "${archive}"
-                LOGNAME "msys-${TARGET_TRIPLET}-${index}"
-                WORKING_DIRECTORY "${path_to_root}.tmp"
-            )
-            math(EXPR index "${index} + 1")
+    if(DEFINED Z_VCPKG_PREFETCH_COLLECT)
+        # The collection pass of z_vcpkg_prefetch_downloads() only records the packages;
+        # those which are already downloaded are skipped when the plan is fetched.
+        foreach(entry IN LISTS Z_VCPKG_MSYS_DOWNLOADS)
+            string(REPLACE "\t" ";" fields "${entry}")
+            list(POP_FRONT fields sha512 filename)
+            z_vcpkg_prefetch_downloads_record("${filename}" "${sha512}" ${fields})
         endforeach()
-        file(RENAME "${path_to_root}.tmp" "${path_to_root}")
+        set("${out_msys_root}" "${path_to_root}" PARENT_SCOPE)
+        return()
+    endif()
+    file(MAKE_DIRECTORY "${DOWNLOADS}/tools/msys2")
+    # other builds may assemble the same root at the same time
+    file(LOCK "${path_to_root}.lock" GUARD FUNCTION)
+    if(NOT EXISTS "${path_to_root}")
+        z_vcpkg_acquire_msys_assemble_root("${path_to_root}" ${Z_VCPKG_MSYS_DOWNLOADS})
     endif()
     # Due to skipping the regular MSYS2 installer,
     # some config files need to be established explicitly.
@@ -25,6 +25,19 @@ This command should be preceded by a call to [`vcpkg_configure_cmake()`](vcpkg_c
 You can use the alias [`vcpkg_install_cmake()`](vcpkg_configure_cmake.md) function if your CMake script supports the
 "install" target
 
+If `VCPKG_CONCURRENT_CONFIG_BUILDS` is set to `ON` in the triplet and the project was configured with Ninja,
+the Debug and Release builds run at the same time, so that the configure-bound and link-bound phases
+of one configuration overlap with the compile jobs of the other.
+Each build is passed `-l${VCPKG_CONCURRENCY}` in addition to `-j${VCPKG_CONCURRENCY}`,
+so neither starts new jobs while the machine is already fully loaded,
+and either can use all cores once the other has finished.
+With `VCPKG_MEMORY_PER_BUILD_JOB`, each build is limited to half of the available memory.
+Each build runs through [`vcpkg_execute_build_process()`](vcpkg_execute_build_process.md),
+so it is restarted with fewer jobs if it runs out of memory.
+If the concurrent build fails, the configurations are built one after the other as usual,
+which also reports the failure.
+This mode is not used with `DISABLE_PARALLEL` or `ADD_BIN_TO_PATH`.
+
 ## Examples:
 
 * [zlib](https://github.com/Microsoft/vcpkg/blob/master/ports/zlib/portfile.cmake)
@@ -33,7 +46,82 @@ You can use the alias [`vcpkg_install_cmake()`](vcpkg_configure_cmake.md) functi
 * [opencv](https://github.com/Microsoft/vcpkg/blob/master/ports/opencv/portfile.cmake)
 #]===]
 
+# Builds the dbg and rel trees at the same time through a generated ninja file.
+# Each build runs through vcpkg_execute_build_process() in its own cmake process and writes its output to the logs the sequential build would use.
+function(z_vcpkg_build_cmake_concurrently out_var)
+    cmake_parse_arguments(PARSE_ARGV 1 "arg" "" "LOGFILE_ROOT" "TARGET_PARAM;BUILD_ARGS")
+
+    vcpkg_find_acquire_program(NINJA)
+
+    set(ninja_dir "${CURRENT_BUILDTREES_DIR}/${TARGET_TRIPLET}-rel/vcpkg-parallel-build")
+    file(MAKE_DIRECTORY "${ninja_dir}")
+
+    if(DEFINED VCPKG_MEMORY_PER_BUILD_JOB)
+        # the jobs of both builds share the memory of the host
+        cmake_host_system_information(RESULT available_memory QUERY AVAILABLE_PHYSICAL_MEMORY)
+        math(EXPR available_memory "${available_memory} / 2")
+    endif()
+
+    set(contents "rule BuildConfig\n  command = $process\n\n")
+    foreach(short_buildtype IN ITEMS "dbg" "rel")
+        if(short_buildtype STREQUAL "dbg")
+            set(config "Debug")
+        else()
+            set(config "Release")
+        endif()
+        set(build_command "${CMAKE_COMMAND}" --build . --config ${config} ${arg_TARGET_PARAM} -- ${arg_BUILD_ARGS})
+        set(command "")
+        foreach(arg IN LISTS build_command)
+            string(APPEND command " [==[${arg}]==]")
+        endforeach()
+
+        set(script "${ninja_dir}/build-${short_buildtype}.cmake")
+        file(WRITE "${script}" "\
+set(CURRENT_BUILDTREES_DIR [==[${CURRENT_BUILDTREES_DIR}]==])
+set(TARGET_TRIPLET [==[${TARGET_TRIPLET}]==])
+set(SHORT_BUILDTYPE ${short_buildtype})
+")
+        if(DEFINED VCPKG_MEMORY_PER_BUILD_JOB)
+            file(APPEND "${script}" "\
+set(VCPKG_MEMORY_PER_BUILD_JOB [==[${VCPKG_MEMORY_PER_BUILD_JOB}]==])
+set(Z_VCPKG_EXECUTE_BUILD_PROCESS_AVAILABLE_MEMORY ${available_memory})
+")
+        endif()
+        file(APPEND "${script}" "\
+include([==[${SCRIPTS}/cmake/z_vcpkg_prettify_command_line.cmake]==])
+include([==[${SCRIPTS}/cmake/vcpkg_execute_build_process.cmake]==])
+vcpkg_execute_build_process(
+    COMMAND${command} -j${VCPKG_CONCURRENCY} -l${VCPKG_CONCURRENCY}
+    NO_PARALLEL_COMMAND${command} -j1
+    WORKING_DIRECTORY [==[${CURRENT_BUILDTREES_DIR}/${TARGET_TRIPLET}-${short_buildtype}]==]
+    LOGNAME [==[${arg_LOGFILE_ROOT}-${TARGET_TRIPLET}-${short_buildtype}]==]
+)
+")
+        set(process "\"${CMAKE_COMMAND}\" -P \"${script}\"")
+        string(REPLACE "$" "$$" process "${process}")
+        # the outputs are never created, so both builds always run
+        string(APPEND contents "build ${short_buildtype}.stamp: BuildConfig\n  process = ${process}\n\n")
+    endforeach()
+    file(WRITE "${ninja_dir}/build.ninja" "${contents}")
+
+    message(STATUS "Building ${TARGET_TRIPLET}-dbg and ${TARGET_TRIPLET}-rel concurrently")
+    execute_process(
+        COMMAND "${NINJA}" -v -j2
+        WORKING_DIRECTORY "${ninja_dir}"
+        OUTPUT_FILE "${CURRENT_BUILDTREES_DIR}/${arg_LOGFILE_ROOT}-${TARGET_TRIPLET}-out.log"
+        ERROR_FILE "${CURRENT_BUILDTREES_DIR}/${arg_LOGFILE_ROOT}-${TARGET_TRIPLET}-err.log"
+        RESULT_VARIABLE error_code
+    )
+    if(error_code EQUAL "0")
+        set("${out_var}" ON PARENT_SCOPE)
+    else()
+        message(STATUS "Concurrent build failed; building ${TARGET_TRIPLET}-dbg and ${TARGET_TRIPLET}-rel one at a time")
+        set("${out_var}" OFF PARENT_SCOPE)
+    endif()
+endfunction()
+
 function(vcpkg_build_cmake)
+    z_vcpkg_timing_begin(build)
     cmake_parse_arguments(PARSE_ARGV 0 "arg"
         "DISABLE_PARALLEL;ADD_BIN_TO_PATH"
         "TARGET;LOGFILE_ROOT"
@@ -73,6 +161,19 @@ function(vcpkg_build_cmake)
         set(TARGET_PARAM)
     endif()
 
+    if(VCPKG_CONCURRENT_CONFIG_BUILDS AND NOT DEFINED VCPKG_BUILD_TYPE AND Z_VCPKG_CMAKE_GENERATOR MATCHES "Ninja"
+            AND NOT arg_DISABLE_PARALLEL AND NOT arg_ADD_BIN_TO_PATH)
+        z_vcpkg_build_cmake_concurrently(CONCURRENT_BUILD_SUCCEEDED
+            LOGFILE_ROOT "${arg_LOGFILE_ROOT}"
+            TARGET_PARAM ${TARGET_PARAM}
+            BUILD_ARGS ${BUILD_ARGS}
+        )
+        if(CONCURRENT_BUILD_SUCCEEDED)
+            z_vcpkg_timing_end(build "${CMAKE_CURRENT_FUNCTION}")
+            return()
+        endif()
+    endif()
+
     foreach(BUILDTYPE "debug" "release")
         if(NOT DEFINED VCPKG_BUILD_TYPE OR VCPKG_BUILD_TYPE STREQUAL BUILDTYPE)
             if(BUILDTYPE STREQUAL "debug")
@@ -114,4 +215,5 @@ function(vcpkg_build_cmake)
             endif()
         endif()
     endforeach()
+    z_vcpkg_timing_end(build "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -51,6 +51,7 @@ You can use the alias [`vcpkg_install_make()`](vcpkg_install_make.md) function i
 #]===]
 
 function(vcpkg_build_make)
+    z_vcpkg_timing_begin(build)
     if(NOT _VCPKG_CMAKE_VARS_FILE)
         # vcpkg_build_make called without using vcpkg_configure_make before
         vcpkg_internal_get_cmake_vars(OUTPUT_FILE _VCPKG_CMAKE_VARS_FILE)
@@ -248,4 +249,5 @@ function(vcpkg_build_make)
     endif()
 
     _vcpkg_restore_env_variables(LIB LIBPATH LIBRARY_PATH LD_LIBRARY_PATH)
+    z_vcpkg_timing_end(build "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -63,6 +63,7 @@ Additional options passed to msbuild for Debug builds. These are in addition to
 #]===]
 
 function(vcpkg_build_msbuild)
+    z_vcpkg_timing_begin(build)
     cmake_parse_arguments(
         PARSE_ARGV 0
         arg
@@ -148,4 +149,5 @@ function(vcpkg_build_msbuild)
             LOGNAME "build-${TARGET_TRIPLET}-dbg"
         )
     endif()
+    z_vcpkg_timing_end(build "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
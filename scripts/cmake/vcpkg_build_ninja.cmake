@@ -26,6 +26,7 @@ endfunction()
 
 
 function(vcpkg_build_ninja)
+    z_vcpkg_timing_begin(build)
     cmake_parse_arguments(PARSE_ARGV 0 arg "" "" "TARGETS")
 
     if(DEFINED arg_UNPARSED_ARGUMENTS)
@@ -44,4 +45,5 @@ function(vcpkg_build_ninja)
     if(NOT DEFINED VCPKG_BUILD_TYPE OR VCPKG_BUILD_TYPE STREQUAL "release")
         z_vcpkg_build_ninja_build("${TARGET_TRIPLET}-rel" "${arg_TARGETS}")
     endif()
+    z_vcpkg_timing_end(build "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
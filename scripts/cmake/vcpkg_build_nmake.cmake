@@ -75,6 +75,7 @@ You can use the alias [`vcpkg_install_nmake()`](vcpkg_install_nmake.md) function
 #]===]
 
 function(vcpkg_build_nmake)
+    z_vcpkg_timing_begin(build)
     # parse parameters such that semicolons in options arguments to COMMAND don't get erased
     cmake_parse_arguments(PARSE_ARGV 0 _bn
         "ADD_BIN_TO_PATH;ENABLE_INSTALL;NO_DEBUG"
@@ -229,4 +230,5 @@ function(vcpkg_build_nmake)
             endif()
         endif()
     endforeach()
+    z_vcpkg_timing_end(build "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
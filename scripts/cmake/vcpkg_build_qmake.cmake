@@ -9,6 +9,7 @@ vcpkg_build_qmake()
 #]===]
 
 function(vcpkg_build_qmake)
+    z_vcpkg_timing_begin(build)
     # parse parameters such that semicolons in options arguments to COMMAND don't get erased
     cmake_parse_arguments(PARSE_ARGV 0 _csc "SKIP_MAKEFILES" "BUILD_LOGNAME" "TARGETS;RELEASE_TARGETS;DEBUG_TARGETS")
 
@@ -106,4 +107,5 @@ function(vcpkg_build_qmake)
     # Restore the original value of ENV{PATH}
     set(ENV{PATH} "${ENV_PATH_BACKUP}")
     set(ENV{_CL_} "${ENV_CL_BACKUP}")
+    z_vcpkg_timing_end(build "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
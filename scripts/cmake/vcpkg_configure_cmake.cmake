@@ -72,6 +72,7 @@ This command supplies many common arguments to CMake. To see the full list, exam
 #]===]
 
 function(vcpkg_configure_cmake)
+    z_vcpkg_timing_begin(configure)
     if(Z_VCPKG_CMAKE_CONFIGURE_GUARD)
         message(FATAL_ERROR "The ${PORT} port already depends on vcpkg-cmake; using both vcpkg-cmake and vcpkg_configure_cmake in the same port is unsupported.")
     endif()
@@ -304,7 +305,7 @@ function(vcpkg_configure_cmake)
         -DCMAKE_BUILD_TYPE=Debug
         -DCMAKE_INSTALL_PREFIX=${CURRENT_PACKAGES_DIR}/debug)
 
-    if(NINJA_HOST AND CMAKE_HOST_WIN32 AND NOT arg_DISABLE_PARALLEL_CONFIGURE)
+    if(NINJA_HOST AND NOT arg_DISABLE_PARALLEL_CONFIGURE)
         list(APPEND arg_OPTIONS "-DCMAKE_DISABLE_SOURCE_CHANGES=ON")
 
         vcpkg_find_acquire_program(NINJA)
@@ -316,13 +317,26 @@ function(vcpkg_configure_cmake)
             "rule CreateProcess\n  command = $process\n\n"
         )
 
-        macro(_build_cmakecache whereat build_type)
-            set(${build_type}_line "build ${whereat}/CMakeCache.txt: CreateProcess\n  process = cmd /c \"cd ${whereat} &&")
-            foreach(arg ${${build_type}_command})
-                set(${build_type}_line "${${build_type}_line} \"${arg}\"")
-            endforeach()
-            set(_contents "${_contents}${${build_type}_line}\"\n\n")
-        endmacro()
+        if(CMAKE_HOST_WIN32)
+            macro(_build_cmakecache whereat build_type)
+                set(${build_type}_line "build ${whereat}/CMakeCache.txt: CreateProcess\n  process = cmd /c \"cd ${whereat} &&")
+                foreach(arg ${${build_type}_command})
+                    set(${build_type}_line "${${build_type}_line} \"${arg}\"")
+                endforeach()
+                set(_contents "${_contents}${${build_type}_line}\"\n\n")
+            endmacro()
+        else()
+            # ninja runs commands through /bin/sh here, so single-quote each argument for the shell and escape `$` for ninja
+            macro(_build_cmakecache whereat build_type)
+                set(${build_type}_line "build ${whereat}/CMakeCache.txt: CreateProcess\n  process = cd '${whereat}' &&")
+                foreach(arg ${${build_type}_command})
+                    string(REPLACE "'" "'\\''" arg "${arg}")
+                    string(REPLACE "$" "$$" arg "${arg}")
+                    set(${build_type}_line "${${build_type}_line} '${arg}'")
+                endforeach()
+                set(_contents "${_contents}${${build_type}_line}\n\n")
+            endmacro()
+        endif()
 
         if(NOT DEFINED VCPKG_BUILD_TYPE)
             _build_cmakecache(".." "rel")
@@ -409,4 +423,5 @@ If these options should still be passed for whatever reason, please use the `MAY
     endif()
 
     set(Z_VCPKG_CMAKE_GENERATOR "${GENERATOR}" PARENT_SCOPE)
+    z_vcpkg_timing_end(configure "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
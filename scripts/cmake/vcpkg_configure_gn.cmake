@@ -43,6 +43,7 @@ function(z_vcpkg_configure_gn_generate)
 endfunction()
 
 function(vcpkg_configure_gn)
+    z_vcpkg_timing_begin(configure)
     cmake_parse_arguments(PARSE_ARGV 0 "arg" "" "SOURCE_PATH;OPTIONS;OPTIONS_DEBUG;OPTIONS_RELEASE" "")
 
     if(DEFINED arg_UNPARSED_ARGUMENTS)
@@ -73,4 +74,5 @@ function(vcpkg_configure_gn)
             ARGS "--args=${arg_OPTIONS} ${arg_OPTIONS_RELEASE}"
         )
     endif()
+    z_vcpkg_timing_end(configure "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -81,6 +81,13 @@ List of additional environment variables to pass via the configure call.
 ## Notes
 This command supplies many common arguments to configure. To see the full list, examine the source.
 
+When the `VCPKG_MAKE_CONFIGURE_CACHE` triplet variable is `ON`, autoconf-generated configure scripts are run with a cache file
+that is seeded with the results of feature checks which other ports of the triplet already ran.
+
+When the `VCPKG_CACHE_AUTORECONF_OUTPUT` triplet variable is `ON`, the files generated by `autoreconf` or `autogen.sh`
+are kept in `downloads/autoreconf-output`, keyed on the autotools inputs of the source tree and the versions of the autotools,
+and restored instead of running the autotools again.
+
 ## Examples
 
 * [x264](https://github.com/Microsoft/vcpkg/blob/master/ports/x264/portfile.cmake)
@@ -230,6 +237,7 @@ macro(_vcpkg_extract_cpp_flags_and_set_cflags_and_cxxflags _SUFFIX)
 endmacro()
 
 function(vcpkg_configure_make)
+    z_vcpkg_timing_begin(configure)
     # parse parameters such that semicolons in options arguments to COMMAND don't get erased
     cmake_parse_arguments(PARSE_ARGV 0 _csc
         "AUTOCONFIG;SKIP_CONFIGURE;COPY_SOURCE;DISABLE_VERBOSE_FLAGS;NO_ADDITIONAL_PATHS;ADD_BIN_TO_PATH;USE_WRAPPERS;DETERMINE_BUILD_TRIPLET"
@@ -369,6 +377,20 @@ function(vcpkg_configure_make)
                 endif()
             endif()
         endforeach()
+        z_vcpkg_get_compiler_launcher(compiler_launcher)
+        if(NOT compiler_launcher STREQUAL "" AND NOT _csc_USE_WRAPPERS)
+            # Like the programs above, the launcher is found via PATH since its full path may contain spaces
+            list(POP_FRONT compiler_launcher launcher_path)
+            get_filename_component(launcher_dir "${launcher_path}" DIRECTORY)
+            get_filename_component(launcher_name "${launcher_path}" NAME)
+            vcpkg_add_to_path(PREPEND "${launcher_dir}")
+            list(PREPEND compiler_launcher "${launcher_name}")
+            list(JOIN compiler_launcher " " compiler_launcher)
+            string(APPEND compiler_launcher " ")
+        else()
+            # The compile wrapper needs to see the compiler itself
+            set(compiler_launcher "")
+        endif()
         if (_csc_USE_WRAPPERS)
             _vcpkg_append_to_configure_environment(CONFIGURE_ENV CPP "compile ${VCPKG_DETECTED_CMAKE_C_COMPILER} -E")
 
@@ -384,9 +406,9 @@ function(vcpkg_configure_make)
             endif()
         else()
             _vcpkg_append_to_configure_environment(CONFIGURE_ENV CPP "${VCPKG_DETECTED_CMAKE_C_COMPILER} -E")
-            _vcpkg_append_to_configure_environment(CONFIGURE_ENV CC "${VCPKG_DETECTED_CMAKE_C_COMPILER}")
-            _vcpkg_append_to_configure_environment(CONFIGURE_ENV CC_FOR_BUILD "${VCPKG_DETECTED_CMAKE_C_COMPILER}")
-            _vcpkg_append_to_configure_environment(CONFIGURE_ENV CXX "${VCPKG_DETECTED_CMAKE_CXX_COMPILER}")
+            _vcpkg_append_to_configure_environment(CONFIGURE_ENV CC "${compiler_launcher}${VCPKG_DETECTED_CMAKE_C_COMPILER}")
+            _vcpkg_append_to_configure_environment(CONFIGURE_ENV CC_FOR_BUILD "${compiler_launcher}${VCPKG_DETECTED_CMAKE_C_COMPILER}")
+            _vcpkg_append_to_configure_environment(CONFIGURE_ENV CXX "${compiler_launcher}${VCPKG_DETECTED_CMAKE_CXX_COMPILER}")
             _vcpkg_append_to_configure_environment(CONFIGURE_ENV RC "${VCPKG_DETECTED_CMAKE_RC_COMPILER}")
             _vcpkg_append_to_configure_environment(CONFIGURE_ENV WINDRES "${VCPKG_DETECTED_CMAKE_RC_COMPILER}")
             if(VCPKG_DETECTED_CMAKE_AR)
@@ -447,6 +469,23 @@ function(vcpkg_configure_make)
             # Currently needed for arm because objdump yields: "unrecognised machine type (0x1c4) in Import Library Format archive"
             list(APPEND _csc_OPTIONS lt_cv_deplibs_check_method=pass_all)
         endif()
+    else()
+        set(_vcm_launcher_env_vars "")
+        z_vcpkg_get_compiler_launcher(compiler_launcher)
+        if(NOT compiler_launcher STREQUAL "")
+            # configure picks up CC and CXX from the environment and records them in the generated makefiles
+            list(JOIN compiler_launcher " " compiler_launcher)
+            set(_vcm_launcher_env_vars CC CXX)
+            _vcpkg_backup_env_variables(${_vcm_launcher_env_vars})
+            if(NOT DEFINED ENV{CC})
+                set(ENV{CC} "${VCPKG_DETECTED_CMAKE_C_COMPILER}")
+            endif()
+            if(NOT DEFINED ENV{CXX})
+                set(ENV{CXX} "${VCPKG_DETECTED_CMAKE_CXX_COMPILER}")
+            endif()
+            set(ENV{CC} "${compiler_launcher} $ENV{CC}")
+            set(ENV{CXX} "${compiler_launcher} $ENV{CXX}")
+        endif()
     endif()
 
     if(CMAKE_HOST_WIN32)
@@ -624,7 +663,16 @@ function(vcpkg_configure_make)
 
     # Run autoconf if necessary
     set(_GENERATED_CONFIGURE FALSE)
-    if (_csc_AUTOCONFIG OR REQUIRES_AUTOCONFIG)
+    set(_autoreconf_restored OFF)
+    set(_autoreconf_cache_entry "")
+    if(_csc_AUTOCONFIG OR REQUIRES_AUTOCONFIG OR REQUIRES_AUTOGEN)
+        z_vcpkg_autoreconf_cache_restore(_autoreconf_restored _autoreconf_cache_entry
+            SOURCE_PATH "${SRC_DIR}"
+            SHELL ${base_cmd}
+            KEY "AUTOCONFIG=${_csc_AUTOCONFIG}" "REQUIRES_AUTOCONFIG=${REQUIRES_AUTOCONFIG}" "REQUIRES_AUTOGEN=${REQUIRES_AUTOGEN}"
+        )
+    endif()
+    if ((_csc_AUTOCONFIG OR REQUIRES_AUTOCONFIG) AND NOT _autoreconf_restored)
         find_program(AUTORECONF autoreconf)
         if(NOT AUTORECONF)
             message(FATAL_ERROR "${PORT} requires autoconf from the system package manager (example: \"sudo apt-get install autoconf\")")
@@ -645,7 +693,7 @@ function(vcpkg_configure_make)
         endif()
         message(STATUS "Finished generating configure for ${TARGET_TRIPLET}")
     endif()
-    if(REQUIRES_AUTOGEN)
+    if(REQUIRES_AUTOGEN AND NOT _autoreconf_restored)
         message(STATUS "Generating configure for ${TARGET_TRIPLET} via autogen.sh")
         if (CMAKE_HOST_WIN32)
             vcpkg_execute_required_process(
@@ -662,6 +710,9 @@ function(vcpkg_configure_make)
         endif()
         message(STATUS "Finished generating configure for ${TARGET_TRIPLET}")
     endif()
+    if(NOT _autoreconf_cache_entry STREQUAL "")
+        z_vcpkg_autoreconf_cache_store("${_autoreconf_cache_entry}" SOURCE_PATH "${SRC_DIR}")
+    endif()
 
     if (_csc_PRERUN_SHELL)
         message(STATUS "Prerun shell with ${TARGET_TRIPLET}")
@@ -739,6 +790,16 @@ function(vcpkg_configure_make)
         unset(_VAR_SUFFIX)
     endif()
 
+    macro(_vcpkg_make_configure_command cache_option)
+        if(CMAKE_HOST_WIN32)
+            set(command "${base_cmd}" -c "${CONFIGURE_ENV} ./${RELATIVE_BUILD_PATH}/configure ${_csc_BUILD_TRIPLET} ${_csc_OPTIONS} ${_csc_OPTIONS_${_buildtype}} ${cache_option}")
+        elseif(VCPKG_TARGET_IS_WINDOWS)
+            set(command "${base_cmd}" -c "${CONFIGURE_ENV} $@" -- "./${RELATIVE_BUILD_PATH}/configure" ${_csc_BUILD_TRIPLET} ${_csc_OPTIONS} ${_csc_OPTIONS_${_buildtype}} ${cache_option})
+        else()
+            set(command "${base_cmd}" "./${RELATIVE_BUILD_PATH}/configure" ${_csc_BUILD_TRIPLET} ${_csc_OPTIONS} ${_csc_OPTIONS_${_buildtype}} ${cache_option})
+        endif()
+    endmacro()
+
     foreach(_buildtype IN LISTS _buildtypes)
         foreach(ENV_VAR ${_csc_CONFIG_DEPENDENT_ENVIRONMENT})
             if(DEFINED ENV{${ENV_VAR}})
@@ -795,12 +856,17 @@ function(vcpkg_configure_make)
         unset(_link_path)
         unset(_lib_env_vars)
 
-        if(CMAKE_HOST_WIN32)
-            set(command "${base_cmd}" -c "${CONFIGURE_ENV} ./${RELATIVE_BUILD_PATH}/configure ${_csc_BUILD_TRIPLET} ${_csc_OPTIONS} ${_csc_OPTIONS_${_buildtype}}")
-        elseif(VCPKG_TARGET_IS_WINDOWS)
-            set(command "${base_cmd}" -c "${CONFIGURE_ENV} $@" -- "./${RELATIVE_BUILD_PATH}/configure" ${_csc_BUILD_TRIPLET} ${_csc_OPTIONS} ${_csc_OPTIONS_${_buildtype}})
-        else()
-            set(command "${base_cmd}" "./${RELATIVE_BUILD_PATH}/configure" ${_csc_BUILD_TRIPLET} ${_csc_OPTIONS} ${_csc_OPTIONS_${_buildtype}})
+        _vcpkg_make_configure_command("")
+
+        set(_shared_configure_cache "")
+        if(NOT _csc_SKIP_CONFIGURE)
+            z_vcpkg_make_configure_cache_seed(_shared_configure_cache
+                CONFIGURE_SCRIPT "${TAR_DIR}/${RELATIVE_BUILD_PATH}/configure"
+                WORKING_DIRECTORY "${TAR_DIR}"
+                BUILD_TYPE "${_buildtype}"
+                OPTIONS ${_csc_BUILD_TRIPLET} ${_csc_OPTIONS} ${_csc_OPTIONS_${_buildtype}}
+                KEY "${CONFIGURE_ENV}"
+            )
         endif()
         
         if(_csc_ADD_BIN_TO_PATH)
@@ -810,11 +876,34 @@ function(vcpkg_configure_make)
         debug_message("Configure command:'${command}'")
         if (NOT _csc_SKIP_CONFIGURE)
             message(STATUS "Configuring ${TARGET_TRIPLET}-${SHORT_NAME_${_buildtype}}")
-            vcpkg_execute_required_process(
-                COMMAND ${command}
-                WORKING_DIRECTORY "${TAR_DIR}"
-                LOGNAME config-${TARGET_TRIPLET}-${SHORT_NAME_${_buildtype}}
-            )
+            set(_configured OFF)
+            if(NOT _shared_configure_cache STREQUAL "")
+                # A failure with results of other ports is not trusted; configure runs again without them.
+                _vcpkg_make_configure_command("--cache-file=config.cache")
+                debug_message("Configure command:'${command}'")
+                execute_process(
+                    COMMAND ${command}
+                    WORKING_DIRECTORY "${TAR_DIR}"
+                    OUTPUT_FILE "${CURRENT_BUILDTREES_DIR}/config-${TARGET_TRIPLET}-${SHORT_NAME_${_buildtype}}-out.log"
+                    ERROR_FILE "${CURRENT_BUILDTREES_DIR}/config-${TARGET_TRIPLET}-${SHORT_NAME_${_buildtype}}-err.log"
+                    RESULT_VARIABLE _error_code
+                )
+                if(_error_code EQUAL "0")
+                    set(_configured ON)
+                    z_vcpkg_make_configure_cache_update("${_shared_configure_cache}" WORKING_DIRECTORY "${TAR_DIR}")
+                else()
+                    message(STATUS "Configuring ${TARGET_TRIPLET}-${SHORT_NAME_${_buildtype}} with the shared autoconf cache failed; retrying without it")
+                    file(REMOVE "${TAR_DIR}/config.cache")
+                    _vcpkg_make_configure_command("")
+                endif()
+            endif()
+            if(NOT _configured)
+                vcpkg_execute_required_process(
+                    COMMAND ${command}
+                    WORKING_DIRECTORY "${TAR_DIR}"
+                    LOGNAME config-${TARGET_TRIPLET}-${SHORT_NAME_${_buildtype}}
+                )
+            endif()
             if(VCPKG_TARGET_IS_WINDOWS AND NOT VCPKG_TARGET_IS_MINGW AND VCPKG_LIBRARY_LINKAGE STREQUAL dynamic)
                 file(GLOB_RECURSE LIBTOOL_FILES "${TAR_DIR}*/libtool")
                 foreach(lt_file IN LISTS LIBTOOL_FILES)
@@ -855,8 +944,9 @@ function(vcpkg_configure_make)
     endforeach()
 
     # Restore environment
-    _vcpkg_restore_env_variables(${_cm_FLAGS} LIB LIBPATH LIBRARY_PATH LD_LIBRARY_PATH)
+    _vcpkg_restore_env_variables(${_cm_FLAGS} ${_vcm_launcher_env_vars} LIB LIBPATH LIBRARY_PATH LD_LIBRARY_PATH)
 
     SET(_VCPKG_PROJECT_SOURCE_PATH ${_csc_SOURCE_PATH} PARENT_SCOPE)
     set(_VCPKG_PROJECT_SUBPATH ${_csc_PROJECT_SUBPATH} PARENT_SCOPE)
+    z_vcpkg_timing_end(configure "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -50,12 +50,18 @@ function(vcpkg_internal_meson_generate_native_file _additional_binaries) #https:
             string(APPEND NATIVE "${proglower} = '${VCPKG_DETECTED_CMAKE_${prog}}'\n")
         endif()
     endforeach()
+    z_vcpkg_get_compiler_launcher(compiler_launcher)
     set(compiler C CXX RC)
     foreach(prog IN LISTS compiler)
         if(VCPKG_DETECTED_CMAKE_${prog}_COMPILER)
             string(REPLACE "CXX" "CPP" mesonprog "${prog}")
             string(TOLOWER "${mesonprog}" proglower)
-            string(APPEND NATIVE "${proglower} = '${VCPKG_DETECTED_CMAKE_${prog}_COMPILER}'\n")
+            if(NOT prog STREQUAL "RC" AND NOT compiler_launcher STREQUAL "")
+                vcpkg_internal_meson_convert_list_to_python_array(compiler_command ${compiler_launcher} "${VCPKG_DETECTED_CMAKE_${prog}_COMPILER}")
+                string(APPEND NATIVE "${proglower} = ${compiler_command}\n")
+            else()
+                string(APPEND NATIVE "${proglower} = '${VCPKG_DETECTED_CMAKE_${prog}_COMPILER}'\n")
+            endif()
         endif()
     endforeach()
     if(VCPKG_DETECTED_CMAKE_LINKER AND VCPKG_TARGET_IS_WINDOWS)
@@ -273,12 +279,18 @@ function(vcpkg_internal_meson_generate_cross_file _additional_binaries) #https:/
             string(APPEND CROSS "${proglower} = '${VCPKG_DETECTED_CMAKE_${prog}}'\n")
         endif()
     endforeach()
+    z_vcpkg_get_compiler_launcher(compiler_launcher)
     set(compiler C CXX RC)
     foreach(prog IN LISTS compiler)
         if(VCPKG_DETECTED_CMAKE_${prog}_COMPILER)
             string(REPLACE "CXX" "CPP" mesonprog "${prog}")
             string(TOLOWER "${mesonprog}" proglower)
-            string(APPEND CROSS "${proglower} = '${VCPKG_DETECTED_CMAKE_${prog}_COMPILER}'\n")
+            if(NOT prog STREQUAL "RC" AND NOT compiler_launcher STREQUAL "")
+                vcpkg_internal_meson_convert_list_to_python_array(compiler_command ${compiler_launcher} "${VCPKG_DETECTED_CMAKE_${prog}_COMPILER}")
+                string(APPEND CROSS "${proglower} = ${compiler_command}\n")
+            else()
+                string(APPEND CROSS "${proglower} = '${VCPKG_DETECTED_CMAKE_${prog}_COMPILER}'\n")
+            endif()
         endif()
     endforeach()
     if(VCPKG_DETECTED_CMAKE_LINKER AND VCPKG_TARGET_IS_WINDOWS)
@@ -350,6 +362,7 @@ endfunction()
 
 
 function(vcpkg_configure_meson)
+    z_vcpkg_timing_begin(configure)
     # parse parameters such that semicolons in options arguments to COMMAND don't get erased
     cmake_parse_arguments(PARSE_ARGV 0 _vcm "" "SOURCE_PATH" "OPTIONS;OPTIONS_DEBUG;OPTIONS_RELEASE;ADDITIONAL_NATIVE_BINARIES;ADDITIONAL_CROSS_BINARIES")
 
@@ -523,4 +536,5 @@ function(vcpkg_configure_meson)
             unset(ENV{MACOSX_DEPLOYMENT_TARGET})
         endif()
     endif()
+    z_vcpkg_timing_end(configure "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -20,6 +20,7 @@ The options passed to qmake.
 #]===]
 
 function(vcpkg_configure_qmake)
+    z_vcpkg_timing_begin(configure)
     # parse parameters such that semicolons in options arguments to COMMAND don't get erased
     cmake_parse_arguments(PARSE_ARGV 0 _csc "" "SOURCE_PATH" "OPTIONS;OPTIONS_RELEASE;OPTIONS_DEBUG;BUILD_OPTIONS;BUILD_OPTIONS_RELEASE;BUILD_OPTIONS_DEBUG")
      
@@ -131,4 +132,5 @@ function(vcpkg_configure_qmake)
         endif()
     endif()
 
+    z_vcpkg_timing_end(configure "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -25,6 +25,7 @@ This command should always be called by portfiles after they have finished rearr
 * [cpprestsdk](https://github.com/Microsoft/vcpkg/blob/master/ports/cpprestsdk/portfile.cmake)
 #]===]
 function(vcpkg_copy_pdbs)
+    z_vcpkg_timing_begin(fixup)
     cmake_parse_arguments(PARSE_ARGV 0 "arg" "" "" "BUILD_PATHS")
 
     if(NOT DEFINED arg_BUILD_PATHS)
@@ -70,4 +71,5 @@ function(vcpkg_copy_pdbs)
         endif()
     endif()
 
+    z_vcpkg_timing_end(fixup "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
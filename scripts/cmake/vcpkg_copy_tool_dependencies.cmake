@@ -20,6 +20,7 @@ This command should always be called by portfiles after they have finished rearr
 #]===]
 
 function(vcpkg_copy_tool_dependencies TOOL_DIR)
+    z_vcpkg_timing_begin(fixup)
     if (VCPKG_TARGET_IS_WINDOWS)
         find_program(PWSH_EXE pwsh)
         if (NOT PWSH_EXE)
@@ -44,4 +45,5 @@ function(vcpkg_copy_tool_dependencies TOOL_DIR)
         search_for_dependencies("${CURRENT_PACKAGES_DIR}/bin")
         search_for_dependencies("${CURRENT_INSTALLED_DIR}/bin")
     endif()
+    z_vcpkg_timing_end(fixup "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
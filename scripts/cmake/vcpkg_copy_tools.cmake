@@ -33,6 +33,7 @@ Auto clean executables in `${CURRENT_PACKAGES_DIR}/bin` and `${CURRENT_PACKAGES_
 #]===]
 
 function(vcpkg_copy_tools)
+    z_vcpkg_timing_begin(fixup)
     # parse parameters such that semicolons in options arguments to COMMAND don't get erased
     cmake_parse_arguments(PARSE_ARGV 0 _vct "AUTO_CLEAN" "SEARCH_DIR;DESTINATION" "TOOL_NAMES")
 
@@ -50,17 +51,32 @@ function(vcpkg_copy_tools)
         message(FATAL_ERROR "SEARCH_DIR ${_vct_SEARCH_DIR} is supposed to be a directory.")
     endif()
 
+    # AUTO_CLEAN would delete the release tools from bin right away, so they can simply be moved.
+    # Otherwise they are hard linked, which falls back to copying across filesystems.
+    if(_vct_AUTO_CLEAN AND _vct_SEARCH_DIR STREQUAL "${CURRENT_PACKAGES_DIR}/bin")
+        set(transfer_mode MOVE)
+    else()
+        set(transfer_mode LINK)
+    endif()
+
+    file(MAKE_DIRECTORY "${_vct_DESTINATION}")
     foreach(tool_name IN LISTS _vct_TOOL_NAMES)
         set(tool_path "${_vct_SEARCH_DIR}/${tool_name}${VCPKG_TARGET_EXECUTABLE_SUFFIX}")
         set(tool_pdb "${_vct_SEARCH_DIR}/${tool_name}.pdb")
-        if(EXISTS "${tool_path}")
-            file(COPY "${tool_path}" DESTINATION "${_vct_DESTINATION}")
-        else()
+        if(NOT EXISTS "${tool_path}")
             message(FATAL_ERROR "Couldn't find this tool: ${tool_path}.")
         endif()
-        if(EXISTS "${tool_pdb}")
-            file(COPY "${tool_pdb}" DESTINATION "${_vct_DESTINATION}")
-        endif()
+        foreach(file_path IN ITEMS "${tool_path}" "${tool_pdb}")
+            if(NOT EXISTS "${file_path}")
+                continue()
+            endif()
+            get_filename_component(file_name "${file_path}" NAME)
+            if(transfer_mode STREQUAL "MOVE")
+                file(RENAME "${file_path}" "${_vct_DESTINATION}/${file_name}")
+            else()
+                file(CREATE_LINK "${file_path}" "${_vct_DESTINATION}/${file_name}" COPY_ON_ERROR)
+            endif()
+        endforeach()
     endforeach()
 
     if(_vct_AUTO_CLEAN)
@@ -68,4 +84,5 @@ function(vcpkg_copy_tools)
     endif()
 
     vcpkg_copy_tool_dependencies("${_vct_DESTINATION}")
+    z_vcpkg_timing_end(fixup "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
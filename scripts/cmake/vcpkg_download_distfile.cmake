@@ -51,6 +51,17 @@ Headers should be specified as "<header-name>: <header-value>".
 ## Notes
 The helper [`vcpkg_from_github`](vcpkg_from_github.md) should be used for downloading from GitHub projects.
 
+Once a file's SHA512 has been verified, it is recorded in `${DOWNLOADS}/verified-hashes`
+together with the file's size and modification time,
+and on non-Windows hosts its inode and the nanosecond modification and status change times.
+Later cache hits trust the recorded hash as long as none of these have changed,
+rather than re-reading the whole file.
+Set `VCPKG_PARANOID_HASH_CHECK` to `ON` in the triplet to always re-hash cached files.
+
+When the `VCPKG_PREFETCH_DOWNLOADS` triplet variable is set to `ON`, a collection pass follows the calls
+of a portfile to this function without downloading anything, before the portfile runs.
+The files with a SHA512 and without `HEADERS` which are missing from `${DOWNLOADS}` are then downloaded concurrently.
+
 ## Examples
 
 * [apr](https://github.com/Microsoft/vcpkg/blob/master/ports/apr/portfile.cmake)
@@ -59,8 +70,74 @@ The helper [`vcpkg_from_github`](vcpkg_from_github.md) should be used for downlo
 #]===]
 
 include(vcpkg_execute_in_download_mode)
+include(z_vcpkg_timing)
+
+# Identifies the on-disk state of a downloaded file without reading its contents.
+function(z_vcpkg_download_distfile_file_key out_var file_path)
+    file(SIZE "${file_path}" size)
+    file(TIMESTAMP "${file_path}" mtime "%s" UTC)
+    # file(TIMESTAMP) only has a resolution of one second, so where stat is available,
+    # the key also contains the inode and the modification and status change times with their fractional seconds.
+    set(stat_fields "")
+    if(CMAKE_HOST_UNIX)
+        if(CMAKE_HOST_APPLE OR CMAKE_HOST_SYSTEM_NAME MATCHES "BSD")
+            set(stat_format -f "%i %Fm %Fc")
+        else()
+            set(stat_format -c "%i %y %z")
+        endif()
+        vcpkg_execute_in_download_mode(
+            COMMAND stat -L ${stat_format} "${file_path}"
+            OUTPUT_VARIABLE stat_fields
+            OUTPUT_STRIP_TRAILING_WHITESPACE
+            ERROR_QUIET
+            RESULT_VARIABLE error_code
+        )
+        if(NOT error_code EQUAL "0")
+            set(stat_fields "")
+        endif()
+    endif()
+    set("${out_var}" "${size}:${mtime}:${stat_fields}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_download_distfile_sidecar_path out_var file_path)
+    file(RELATIVE_PATH relative_path "${DOWNLOADS}" "${file_path}")
+    set("${out_var}" "${DOWNLOADS}/verified-hashes/${relative_path}.sha512" PARENT_SCOPE)
+endfunction()
+
+# Sets out_var to ON if the sidecar for file_path records expected_hash for the file's current key.
+function(z_vcpkg_download_distfile_check_sidecar out_var file_path expected_hash)
+    set("${out_var}" OFF PARENT_SCOPE)
+    if(VCPKG_PARANOID_HASH_CHECK)
+        return()
+    endif()
+    z_vcpkg_download_distfile_sidecar_path(sidecar "${file_path}")
+    if(NOT EXISTS "${sidecar}")
+        return()
+    endif()
+    file(STRINGS "${sidecar}" recorded LIMIT_COUNT 2)
+    list(LENGTH recorded recorded_length)
+    if(NOT recorded_length EQUAL "2")
+        return()
+    endif()
+    list(GET recorded 0 recorded_key)
+    list(GET recorded 1 recorded_hash)
+    z_vcpkg_download_distfile_file_key(current_key "${file_path}")
+    if(recorded_key STREQUAL current_key AND recorded_hash STREQUAL expected_hash)
+        set("${out_var}" ON PARENT_SCOPE)
+    endif()
+endfunction()
+
+function(z_vcpkg_download_distfile_write_sidecar file_path file_hash)
+    z_vcpkg_download_distfile_file_key(current_key "${file_path}")
+    z_vcpkg_download_distfile_sidecar_path(sidecar "${file_path}")
+    # write to a unique name and rename over the sidecar, since other builds may share the downloads directory
+    string(RANDOM LENGTH 8 suffix)
+    file(WRITE "${sidecar}.${suffix}.tmp" "${current_key}\n${file_hash}\n")
+    file(RENAME "${sidecar}.${suffix}.tmp" "${sidecar}")
+endfunction()
 
 function(vcpkg_download_distfile VAR)
+    z_vcpkg_timing_begin(download)
     set(options SKIP_SHA512 SILENT_EXIT QUIET ALWAYS_REDOWNLOAD)
     set(oneValueArgs FILENAME SHA512)
     set(multipleValuesArgs URLS HEADERS)
@@ -102,6 +179,16 @@ function(vcpkg_download_distfile VAR)
     set(downloaded_file_path ${DOWNLOADS}/${vcpkg_download_distfile_FILENAME})
     set(download_file_path_part "${DOWNLOADS}/temp/${vcpkg_download_distfile_FILENAME}")
 
+    if(DEFINED Z_VCPKG_PREFETCH_COLLECT)
+        # The collection pass of z_vcpkg_prefetch_downloads() only records the file.
+        if(NOT vcpkg_download_distfile_SKIP_SHA512 AND NOT vcpkg_download_distfile_HEADERS)
+            z_vcpkg_prefetch_downloads_record("${vcpkg_download_distfile_FILENAME}" "${vcpkg_download_distfile_SHA512}" ${vcpkg_download_distfile_URLS})
+        endif()
+        set(${VAR} ${downloaded_file_path} PARENT_SCOPE)
+        z_vcpkg_timing_end(download "${CMAKE_CURRENT_FUNCTION}")
+        return()
+    endif()
+
     # Works around issue #3399
     if(IS_DIRECTORY "${DOWNLOADS}/temp")
         # Delete "temp0" directory created by the old version of vcpkg
@@ -123,6 +210,13 @@ function(vcpkg_download_distfile VAR)
             return()
         endif()
 
+        if(FILE_KIND STREQUAL "cached file")
+            z_vcpkg_download_distfile_check_sidecar(already_verified "${FILE_PATH}" "${vcpkg_download_distfile_SHA512}")
+            if(already_verified)
+                return()
+            endif()
+        endif()
+
         file(SHA512 ${FILE_PATH} FILE_HASH)
         if(NOT FILE_HASH STREQUAL vcpkg_download_distfile_SHA512)
             message(FATAL_ERROR
@@ -132,6 +226,9 @@ function(vcpkg_download_distfile VAR)
                 "      Actual hash: [ ${FILE_HASH} ]\n"
                 "${CUSTOM_ERROR_ADVICE}\n")
         endif()
+        if(FILE_KIND STREQUAL "cached file")
+            z_vcpkg_download_distfile_write_sidecar("${FILE_PATH}" "${FILE_HASH}")
+        endif()
     endfunction()
 
     # vcpkg_download_distfile_ALWAYS_REDOWNLOAD only triggers when NOT _VCPKG_NO_DOWNLOADS
@@ -273,6 +370,10 @@ function(vcpkg_download_distfile VAR)
                 "    \n"
                 "    Otherwise, please submit an issue at https://github.com/Microsoft/vcpkg/issues\n")
         endif()
+        if(NOT vcpkg_download_distfile_SKIP_SHA512)
+            z_vcpkg_download_distfile_write_sidecar("${downloaded_file_path}" "${vcpkg_download_distfile_SHA512}")
+        endif()
     endif()
     set(${VAR} ${downloaded_file_path} PARENT_SCOPE)
+    z_vcpkg_timing_end(download "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
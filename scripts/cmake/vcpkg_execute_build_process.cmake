@@ -29,6 +29,20 @@ The prefix to use for the log files.
 This should be a unique name for different triplets so that the logs don't
 conflict when building multiple at once.
 
+## Notes
+If the build fails in a way that looks like it ran out of memory
+(see `Z_VCPKG_EXECUTE_BUILD_PROCESS_RETRY_ERROR_MESSAGES`),
+it is restarted in the same working directory with fewer jobs.
+If `COMMAND` contains a `-j<N>` or `-j <N>` argument, the job count is halved on each retry
+until the build succeeds, fails for another reason, or has been retried at `-j1`
+(using `NO_PARALLEL_COMMAND` for that last attempt, if given).
+Otherwise, the build is retried once with `NO_PARALLEL_COMMAND`.
+The job count of every attempt is written to `<log_name>-jobs.log`.
+
+Ports whose compilers or linkers need a lot of memory can set `VCPKG_MEMORY_PER_BUILD_JOB`
+to the expected peak memory use of a single job in MiB.
+The first attempt is then limited to as many jobs as fit in the host's available physical memory.
+
 ## Examples
 
 * [icu](https://github.com/Microsoft/vcpkg/blob/master/ports/icu/portfile.cmake)
@@ -41,6 +55,11 @@ set(Z_VCPKG_EXECUTE_BUILD_PROCESS_RETRY_ERROR_MESSAGES
     "LINK : fatal error LNK1318:"
     "LINK : fatal error LNK1104:"
     "LINK : fatal error LNK1201:"
+    # GCC and Clang were killed by the out-of-memory killer, or could not allocate memory.
+    "Killed signal terminated program"
+    "fatal error: Killed"
+    "error: unable to execute command: Killed"
+    "virtual memory exhausted"
     # Multiple threads using the same directory at the same time cause conflicts, will try again.
     "Cannot create parent directory"
     "Cannot write file"
@@ -49,6 +68,32 @@ set(Z_VCPKG_EXECUTE_BUILD_PROCESS_RETRY_ERROR_MESSAGES
 )
 list(JOIN Z_VCPKG_EXECUTE_BUILD_PROCESS_RETRY_ERROR_MESSAGES "|" Z_VCPKG_EXECUTE_BUILD_PROCESS_RETRY_ERROR_MESSAGES)
 
+# Sets out_jobs to the N of the `-j<N>` or `-j <N>` argument of a build command (or "" if it has none)
+# and out_command to the command with N replaced by new_jobs.
+function(z_vcpkg_execute_build_process_replace_jobs out_jobs out_command new_jobs)
+    set(jobs "")
+    set(command "")
+    set(jobs_follow OFF)
+    foreach(arg IN LISTS ARGN)
+        if(jobs_follow AND arg MATCHES "^[0-9]+$")
+            set(jobs "${arg}")
+            list(APPEND command "${new_jobs}")
+        elseif(arg MATCHES "^-j([0-9]+)$")
+            set(jobs "${CMAKE_MATCH_1}")
+            list(APPEND command "-j${new_jobs}")
+        else()
+            list(APPEND command "${arg}")
+        endif()
+        if(arg STREQUAL "-j")
+            set(jobs_follow ON)
+        else()
+            set(jobs_follow OFF)
+        endif()
+    endforeach()
+    set("${out_jobs}" "${jobs}" PARENT_SCOPE)
+    set("${out_command}" "${command}" PARENT_SCOPE)
+endfunction()
+
 function(vcpkg_execute_build_process)
     cmake_parse_arguments(PARSE_ARGV 0 arg "" "WORKING_DIRECTORY;LOGNAME" "COMMAND;NO_PARALLEL_COMMAND")
 
@@ -69,8 +114,33 @@ function(vcpkg_execute_build_process)
     set(log_prefix "${CURRENT_BUILDTREES_DIR}/${arg_LOGNAME}")
     set(log_out "${log_prefix}-out.log")
     set(log_err "${log_prefix}-err.log")
+    set(log_jobs "${log_prefix}-jobs.log")
     set(all_logs "${log_out}" "${log_err}")
 
+    z_vcpkg_execute_build_process_replace_jobs(jobs unused_command 1 ${arg_COMMAND})
+    if(NOT jobs STREQUAL "" AND DEFINED VCPKG_MEMORY_PER_BUILD_JOB)
+        if(DEFINED Z_VCPKG_EXECUTE_BUILD_PROCESS_AVAILABLE_MEMORY)
+            # the share of the memory for builds which run next to each other
+            set(available_memory "${Z_VCPKG_EXECUTE_BUILD_PROCESS_AVAILABLE_MEMORY}")
+        else()
+            cmake_host_system_information(RESULT available_memory QUERY AVAILABLE_PHYSICAL_MEMORY)
+        endif()
+        math(EXPR max_jobs "${available_memory} / ${VCPKG_MEMORY_PER_BUILD_JOB}")
+        if(max_jobs LESS "1")
+            set(max_jobs 1)
+        endif()
+        if(max_jobs LESS jobs)
+            message(STATUS "Limiting build to -j${max_jobs}: ${available_memory} MiB available, ${VCPKG_MEMORY_PER_BUILD_JOB} MiB per job")
+            set(jobs "${max_jobs}")
+            z_vcpkg_execute_build_process_replace_jobs(unused_jobs arg_COMMAND "${jobs}" ${arg_COMMAND})
+        endif()
+    endif()
+    if(jobs STREQUAL "")
+        file(WRITE "${log_jobs}" "attempt 0: ${arg_LOGNAME}-{out,err}.log: as given\n")
+    else()
+        file(WRITE "${log_jobs}" "attempt 0: ${arg_LOGNAME}-{out,err}.log: with -j${jobs}\n")
+    endif()
+
     execute_process(
         COMMAND ${arg_COMMAND}
         WORKING_DIRECTORY "${arg_WORKING_DIRECTORY}"
@@ -84,28 +154,48 @@ function(vcpkg_execute_build_process)
         file(READ "${log_err}" err_contents)
         set(all_contents "${out_contents}${err_contents}")
         if(all_contents MATCHES "${Z_VCPKG_EXECUTE_BUILD_PROCESS_RETRY_ERROR_MESSAGES}")
-            message(STATUS "Restarting Build without parallelism because memory exceeded")
-            set(log_out "${log_prefix}-out-1.log")
-            set(log_err "${log_prefix}-err-1.log")
-            list(APPEND all_logs "${log_out}" "${log_err}")
+            set(attempt 0)
+            while(1)
+                math(EXPR attempt "${attempt} + 1")
+                if(NOT jobs STREQUAL "")
+                    math(EXPR jobs "${jobs} / 2")
+                endif()
+                if(jobs STREQUAL "" OR jobs LESS_EQUAL "1")
+                    set(jobs 1)
+                    set(jobs_description "without parallelism")
+                    if(DEFINED arg_NO_PARALLEL_COMMAND)
+                        set(retry_command ${arg_NO_PARALLEL_COMMAND})
+                    else()
+                        z_vcpkg_execute_build_process_replace_jobs(unused_jobs retry_command 1 ${arg_COMMAND})
+                    endif()
+                else()
+                    set(jobs_description "with -j${jobs}")
+                    z_vcpkg_execute_build_process_replace_jobs(unused_jobs retry_command "${jobs}" ${arg_COMMAND})
+                endif()
+                message(STATUS "Restarting Build ${jobs_description} because memory exceeded")
 
-            if(DEFINED arg_NO_PARALLEL_COMMAND)
-                execute_process(
-                    COMMAND ${arg_NO_PARALLEL_COMMAND}
-                    WORKING_DIRECTORY "${arg_WORKING_DIRECTORY}"
-                    OUTPUT_FILE "${log_out}"
-                    ERROR_FILE "${log_err}"
-                    RESULT_VARIABLE error_code
-                )
-            else()
+                set(log_out "${log_prefix}-out-${attempt}.log")
+                set(log_err "${log_prefix}-err-${attempt}.log")
+                list(APPEND all_logs "${log_out}" "${log_err}")
+                file(APPEND "${log_jobs}" "attempt ${attempt}: ${arg_LOGNAME}-{out,err}-${attempt}.log: ${jobs_description}\n")
                 execute_process(
-                    COMMAND ${arg_COMMAND}
+                    COMMAND ${retry_command}
                     WORKING_DIRECTORY "${arg_WORKING_DIRECTORY}"
                     OUTPUT_FILE "${log_out}"
                     ERROR_FILE "${log_err}"
                     RESULT_VARIABLE error_code
                 )
-            endif()
+
+                if(error_code EQUAL "0" OR jobs EQUAL "1")
+                    break()
+                endif()
+                file(READ "${log_out}" out_contents)
+                file(READ "${log_err}" err_contents)
+                set(all_contents "${out_contents}${err_contents}")
+                if(NOT all_contents MATCHES "${Z_VCPKG_EXECUTE_BUILD_PROCESS_RETRY_ERROR_MESSAGES}")
+                    break()
+                endif()
+            endwhile()
         elseif(all_contents MATCHES "mt : general error c101008d: ")
             # Antivirus workaround - occasionally files are locked and cause mt.exe to fail
             message(STATUS "mt.exe has failed. This may be the result of anti-virus. Disabling anti-virus on the buildtree folder may improve build speed")
@@ -141,7 +231,7 @@ function(vcpkg_execute_build_process)
 
     if(NOT error_code EQUAL "0")
         set(stringified_logs "")
-        foreach(log IN LISTS all_logs)
+        foreach(log IN LISTS all_logs log_jobs)
             if(NOT EXISTS "${log}")
                 continue()
             endif()
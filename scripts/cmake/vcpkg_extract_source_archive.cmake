@@ -70,6 +70,12 @@ respectively.
 If you need to extract to a location that is not based in `CURRENT_BUILDTREES_DIR`,
 you can use the `WORKING_DIRECTORY` argument to do the same.
 
+If `VCPKG_CACHE_EXTRACTED_SOURCES` is set to `ON` in the triplet,
+the extracted and patched sources are additionally kept in `${DOWNLOADS}/extracted-sources`,
+keyed on the hash of the archive and patches.
+Later extractions with the same key, from any port, triplet or buildtree sharing the downloads directory,
+clone that tree instead of extracting and patching the archive again.
+
 ## Examples
 
 * [libraw](https://github.com/Microsoft/vcpkg/blob/master/ports/libraw/portfile.cmake)
@@ -81,17 +87,53 @@ function(z_vcpkg_extract_source_archive_deprecated_mode archive working_director
     cmake_path(GET archive FILENAME archive_filename)
     if(NOT EXISTS "${working_directory}/${archive_filename}.extracted")
         message(STATUS "Extracting source ${archive}")
-        file(MAKE_DIRECTORY "${working_directory}")
-        vcpkg_execute_required_process(
-            ALLOW_IN_DOWNLOAD_MODE
-            COMMAND "${CMAKE_COMMAND}" -E tar xjf "${archive}"
-            WORKING_DIRECTORY "${working_directory}"
-            LOGNAME extract
+        z_vcpkg_extract_archive(
+            ARCHIVE "${archive}"
+            DESTINATION "${working_directory}"
         )
         file(TOUCH "${working_directory}/${archive_filename}.extracted")
     endif()
 endfunction()
 
+# Extracts the archive into temp_dir, applies the patches and moves the result to destination.
+function(z_vcpkg_extract_source_archive_and_patch destination)
+    cmake_parse_arguments(PARSE_ARGV 1 "arg" "NO_REMOVE_ONE_LEVEL;QUIET" "ARCHIVE;TEMP_DIRECTORY" "PATCHES")
+
+    message(STATUS "Extracting source ${arg_ARCHIVE}")
+    file(REMOVE_RECURSE "${arg_TEMP_DIRECTORY}")
+    z_vcpkg_extract_archive(
+        ARCHIVE "${arg_ARCHIVE}"
+        DESTINATION "${arg_TEMP_DIRECTORY}"
+    )
+
+    if(arg_NO_REMOVE_ONE_LEVEL)
+        cmake_path(SET temp_source_path "${arg_TEMP_DIRECTORY}")
+    else()
+        file(GLOB archive_directory "${arg_TEMP_DIRECTORY}/*")
+        # make sure `archive_directory` is only a single file
+        if(NOT archive_directory MATCHES ";" AND IS_DIRECTORY "${archive_directory}")
+            cmake_path(SET temp_source_path "${archive_directory}")
+        else()
+            message(FATAL_ERROR "Could not unwrap top level directory from archive. Pass NO_REMOVE_ONE_LEVEL to disable this.")
+        endif()
+    endif()
+
+    if(arg_QUIET)
+        set(quiet_param QUIET)
+    else()
+        set(quiet_param "")
+    endif()
+
+    z_vcpkg_apply_patches(
+        SOURCE_PATH "${temp_source_path}"
+        PATCHES ${arg_PATCHES}
+        ${quiet_param}
+    )
+
+    file(RENAME "${temp_source_path}" "${destination}")
+    file(REMOVE_RECURSE "${arg_TEMP_DIRECTORY}")
+endfunction()
+
 function(vcpkg_extract_source_archive)
     if(ARGC LESS_EQUAL "2")
         z_vcpkg_deprecation_message( "Deprecated form of vcpkg_extract_source_archive used:
@@ -107,7 +149,9 @@ function(vcpkg_extract_source_archive)
             set(working_directory "${ARGV1}")
         endif()
 
-        z_vcpkg_extract_source_archive_deprecated_mode("${archive}" "${working_directory}")
+        if(NOT DEFINED Z_VCPKG_PREFETCH_COLLECT)
+            z_vcpkg_extract_source_archive_deprecated_mode("${archive}" "${working_directory}")
+        endif()
         return()
     endif()
 
@@ -166,6 +210,14 @@ function(vcpkg_extract_source_archive)
         string(SUBSTRING "${arg_SOURCE_BASE}" "${start}" -1 arg_SOURCE_BASE)
     endif()
 
+    if(DEFINED Z_VCPKG_PREFETCH_COLLECT)
+        # The collection pass of z_vcpkg_prefetch_downloads() only follows the downloads of the portfile;
+        # the archive may not have been downloaded yet.
+        cmake_path(APPEND working_directory "${arg_SOURCE_BASE}" OUTPUT_VARIABLE source_path)
+        set("${out_source_path}" "${source_path}" PARENT_SCOPE)
+        return()
+    endif()
+
     # Hash the archive hash along with the patches. Take the first 10 chars of the hash
     file(SHA512 "${arg_ARCHIVE}" patchset_hash)
     foreach(patch IN LISTS arg_PATCHES)
@@ -181,6 +233,7 @@ function(vcpkg_extract_source_archive)
     endforeach()
 
     string(SHA512 patchset_hash "${patchset_hash}")
+    set(full_patchset_hash "${patchset_hash}")
     string(SUBSTRING "${patchset_hash}" 0 10 patchset_hash)
     cmake_path(APPEND working_directory "${arg_SOURCE_BASE}-${patchset_hash}"
         OUTPUT_VARIABLE source_path
@@ -198,44 +251,45 @@ function(vcpkg_extract_source_archive)
         endif()
     endif()
 
-    message(STATUS "Extracting source ${arg_ARCHIVE}")
-    cmake_path(APPEND_STRING source_path ".tmp" OUTPUT_VARIABLE temp_dir)
-    file(REMOVE_RECURSE "${temp_dir}")
-    file(MAKE_DIRECTORY "${temp_dir}")
-    vcpkg_execute_required_process(
-        ALLOW_IN_DOWNLOAD_MODE
-        COMMAND "${CMAKE_COMMAND}" -E tar xjf "${arg_ARCHIVE}"
-        WORKING_DIRECTORY "${temp_dir}"
-        LOGNAME extract
-    )
-
+    set(extract_options "")
     if(arg_NO_REMOVE_ONE_LEVEL)
-        cmake_path(SET temp_source_path "${temp_dir}")
-    else()
-        file(GLOB archive_directory "${temp_dir}/*")
-        # make sure `archive_directory` is only a single file
-        if(NOT archive_directory MATCHES ";" AND IS_DIRECTORY "${archive_directory}")
-            cmake_path(SET temp_source_path "${archive_directory}")
-        else()
-            message(FATAL_ERROR "Could not unwrap top level directory from archive. Pass NO_REMOVE_ONE_LEVEL to disable this.")
-        endif()
+        list(APPEND extract_options NO_REMOVE_ONE_LEVEL)
+    endif()
+    if(arg_Z_SKIP_PATCH_CHECK)
+        list(APPEND extract_options QUIET)
     endif()
 
-    if (arg_Z_SKIP_PATCH_CHECK)
-        set(quiet_param QUIET)
+    if(VCPKG_CACHE_EXTRACTED_SOURCES)
+        # The key also covers the options that change the shape of the resulting tree.
+        string(SHA512 cache_key "${full_patchset_hash};${extract_options}")
+        string(SUBSTRING "${cache_key}" 0 32 cache_key)
+        set(cached_source_path "${DOWNLOADS}/extracted-sources/${arg_SOURCE_BASE}-${cache_key}")
+
+        file(MAKE_DIRECTORY "${DOWNLOADS}/extracted-sources")
+        file(LOCK "${cached_source_path}.lock" GUARD FUNCTION)
+        if(NOT EXISTS "${cached_source_path}")
+            z_vcpkg_extract_source_archive_and_patch("${cached_source_path}"
+                ARCHIVE "${arg_ARCHIVE}"
+                TEMP_DIRECTORY "${cached_source_path}.tmp"
+                PATCHES ${arg_PATCHES}
+                ${extract_options}
+            )
+        endif()
+        message(STATUS "Cloning cached source ${cached_source_path}")
+        z_vcpkg_timing_begin(extract)
+        z_vcpkg_clone_directory(SOURCE "${cached_source_path}" DESTINATION "${source_path}")
+        z_vcpkg_timing_end(extract z_vcpkg_clone_directory)
+        file(LOCK "${cached_source_path}.lock" RELEASE)
     else()
-        set(quiet_param "")
+        cmake_path(APPEND_STRING source_path ".tmp" OUTPUT_VARIABLE temp_dir)
+        z_vcpkg_extract_source_archive_and_patch("${source_path}"
+            ARCHIVE "${arg_ARCHIVE}"
+            TEMP_DIRECTORY "${temp_dir}"
+            PATCHES ${arg_PATCHES}
+            ${extract_options}
+        )
     endif()
 
-    z_vcpkg_apply_patches(
-        SOURCE_PATH "${temp_source_path}"
-        PATCHES ${arg_PATCHES}
-        ${quiet_param}
-    )
-
-    file(RENAME "${temp_source_path}" "${source_path}")
-    file(REMOVE_RECURSE "${temp_dir}")
-
     set("${out_source_path}" "${source_path}" PARENT_SCOPE)
     message(STATUS "Using source at ${source_path}")
 endfunction()
@@ -50,6 +50,10 @@ Transform all references matching `/bin/*` to `/${TOOLS_PATH}/*`  on other platf
 Fix `${_IMPORT_PREFIX}` in auto generated targets to be one folder deeper.
 Replace `${CURRENT_INSTALLED_DIR}` with `${_IMPORT_PREFIX}` in configs and targets.
 
+Each file is read and rewritten once, and the config directories are moved by renaming them.
+Every move and every rewrite that changed a file is listed in
+`${CURRENT_BUILDTREES_DIR}/fixup-cmake-targets-${TARGET_TRIPLET}.log`.
+
 ## Examples
 
 * [concurrentqueue](https://github.com/Microsoft/vcpkg/blob/master/ports/concurrentqueue/portfile.cmake)
@@ -57,7 +61,102 @@ Replace `${CURRENT_INSTALLED_DIR}` with `${_IMPORT_PREFIX}` in configs and targe
 * [nlohmann-json](https://github.com/Microsoft/vcpkg/blob/master/ports/nlohmann-json/portfile.cmake)
 #]===]
 
+function(z_vcpkg_fixup_cmake_targets_report line)
+    file(APPEND "${CURRENT_BUILDTREES_DIR}/fixup-cmake-targets-${TARGET_TRIPLET}.log" "${line}\n")
+endfunction()
+
+macro(z_vcpkg_fixup_cmake_targets_record description)
+    if(NOT contents STREQUAL previous_contents)
+        list(APPEND rewrites "${description}")
+        set(previous_contents "${contents}")
+    endif()
+endmacro()
+
+# Applies all rewrites for one file in a single read and write.
+# Uses arg_TOOLS_PATH, arg_NO_PREFIX_CORRECTION and EXECUTABLE_SUFFIX from vcpkg_fixup_cmake_targets.
+function(z_vcpkg_fixup_cmake_targets_rewrite source destination)
+    cmake_parse_arguments(PARSE_ARGV 2 "kind" "RELEASE_TARGETS;DEBUG_TARGETS;TOP_LEVEL" "" "")
+    file(READ "${source}" contents)
+    set(original_contents "${contents}")
+    set(previous_contents "${contents}")
+    set(rewrites "")
+
+    if(kind_RELEASE_TARGETS OR kind_DEBUG_TARGETS)
+        string(REPLACE "${CURRENT_INSTALLED_DIR}" "\${_IMPORT_PREFIX}" contents "${contents}")
+        z_vcpkg_fixup_cmake_targets_record("absolute installed paths to _IMPORT_PREFIX")
+        if(kind_DEBUG_TARGETS)
+            string(REGEX REPLACE "\\\${_IMPORT_PREFIX}/bin/([^ \";]+${EXECUTABLE_SUFFIX})" "\${_IMPORT_PREFIX}/${arg_TOOLS_PATH}/\\1" contents "${contents}")
+        else()
+            string(REGEX REPLACE "\\\${_IMPORT_PREFIX}/bin/([^ \"]+${EXECUTABLE_SUFFIX})" "\${_IMPORT_PREFIX}/${arg_TOOLS_PATH}/\\1" contents "${contents}")
+        endif()
+        z_vcpkg_fixup_cmake_targets_record("executables in bin to ${arg_TOOLS_PATH}")
+    endif()
+    if(kind_DEBUG_TARGETS)
+        string(REPLACE "\${_IMPORT_PREFIX}/lib" "\${_IMPORT_PREFIX}/debug/lib" contents "${contents}")
+        string(REPLACE "\${_IMPORT_PREFIX}/bin" "\${_IMPORT_PREFIX}/debug/bin" contents "${contents}")
+        z_vcpkg_fixup_cmake_targets_record("lib and bin to debug/lib and debug/bin")
+    endif()
+
+    #Fix ${_IMPORT_PREFIX} in cmake generated targets and configs;
+    #Since those can be renamed we have to check in every *.cmake
+    #This correction is not correct for all cases. To make it correct for all cases it needs to consider
+    #original folder deepness to CURRENT_PACKAGES_DIR in comparison to the moved to folder deepness which
+    #is always at least (>=) 2, e.g. share/${PORT}. Currently the code assumes it is always 2 although
+    #this requirement is only true for the *Config.cmake. The targets are not required to be in the same
+    #folder as the *Config.cmake!
+    if(NOT arg_NO_PREFIX_CORRECTION)
+        string(REGEX REPLACE
+            "get_filename_component\\(_IMPORT_PREFIX \"\\\${CMAKE_CURRENT_LIST_FILE}\" PATH\\)(\nget_filename_component\\(_IMPORT_PREFIX \"\\\${_IMPORT_PREFIX}\" PATH\\))*"
+            "get_filename_component(_IMPORT_PREFIX \"\${CMAKE_CURRENT_LIST_FILE}\" PATH)\nget_filename_component(_IMPORT_PREFIX \"\${_IMPORT_PREFIX}\" PATH)\nget_filename_component(_IMPORT_PREFIX \"\${_IMPORT_PREFIX}\" PATH)"
+            contents "${contents}") # see #1044 for details why this replacement is necessary. See #4782 why it must be a regex.
+        z_vcpkg_fixup_cmake_targets_record("_IMPORT_PREFIX computed two directories up")
+        string(REGEX REPLACE
+            "get_filename_component\\(PACKAGE_PREFIX_DIR \"\\\${CMAKE_CURRENT_LIST_DIR}/\\.\\./(\\.\\./)*\" ABSOLUTE\\)"
+            "get_filename_component(PACKAGE_PREFIX_DIR \"\${CMAKE_CURRENT_LIST_DIR}/../../\" ABSOLUTE)"
+            contents "${contents}")
+        string(REGEX REPLACE
+            "get_filename_component\\(PACKAGE_PREFIX_DIR \"\\\${CMAKE_CURRENT_LIST_DIR}/\\.\\.((\\\\|/)\\.\\.)*\" ABSOLUTE\\)"
+            "get_filename_component(PACKAGE_PREFIX_DIR \"\${CMAKE_CURRENT_LIST_DIR}/../../\" ABSOLUTE)"
+            contents "${contents}") # This is a meson-related workaround, see https://github.com/mesonbuild/meson/issues/6955
+        z_vcpkg_fixup_cmake_targets_record("PACKAGE_PREFIX_DIR computed two directories up")
+    endif()
+
+    #Fix wrongly absolute paths to install dir with the correct dir using ${_IMPORT_PREFIX}
+    #This happens if vcpkg built libraries are directly linked to a target instead of using
+    #an imported target for it. We could add more logic here to identify defect target files.
+    #Since the replacement here in a multi config build always requires a generator expression
+    #in front of the absoulte path to ${CURRENT_INSTALLED_DIR}. So the match should always be at
+    #least >:${CURRENT_INSTALLED_DIR}.
+    #In general the following generator expressions should be there:
+    #\$<\$<CONFIG:DEBUG>:${CURRENT_INSTALLED_DIR}/debug/lib/somelib>
+    #and/or
+    #\$<\$<NOT:\$<CONFIG:DEBUG>>:${CURRENT_INSTALLED_DIR}/lib/somelib>
+    #with ${CURRENT_INSTALLED_DIR} being fully expanded
+    string(REPLACE "${CURRENT_INSTALLED_DIR}" [[${_IMPORT_PREFIX}]] contents "${contents}")
+    z_vcpkg_fixup_cmake_targets_record("absolute installed paths to _IMPORT_PREFIX")
+
+    # Patch out any remaining absolute references
+    if(kind_TOP_LEVEL)
+        file(TO_CMAKE_PATH "${CURRENT_PACKAGES_DIR}" cmake_current_packages_dir)
+        string(REPLACE "${cmake_current_packages_dir}" "\${CMAKE_CURRENT_LIST_DIR}/../.." contents "${contents}")
+        z_vcpkg_fixup_cmake_targets_record("absolute package paths to CMAKE_CURRENT_LIST_DIR/../..")
+    endif()
+
+    file(RELATIVE_PATH relative_source "${CURRENT_PACKAGES_DIR}" "${source}")
+    if(NOT source STREQUAL destination)
+        file(RELATIVE_PATH relative_destination "${CURRENT_PACKAGES_DIR}" "${destination}")
+        z_vcpkg_fixup_cmake_targets_report("${relative_source}: moved to ${relative_destination}")
+    elseif(contents STREQUAL original_contents)
+        return()
+    endif()
+    foreach(rewrite IN LISTS rewrites)
+        z_vcpkg_fixup_cmake_targets_report("${relative_source}: ${rewrite}")
+    endforeach()
+    file(WRITE "${destination}" "${contents}")
+endfunction()
+
 function(vcpkg_fixup_cmake_targets)
+    z_vcpkg_timing_begin(fixup)
     if(Z_VCPKG_CMAKE_CONFIG_FIXUP_GUARD)
         message(FATAL_ERROR "The ${PORT} port already depends on vcpkg-cmake-config; using both vcpkg-cmake-config and vcpkg_fixup_cmake_targets in the same port is unsupported.")
     endif()
@@ -78,6 +177,14 @@ function(vcpkg_fixup_cmake_targets)
 
     string(REPLACE "." "\\." EXECUTABLE_SUFFIX "${VCPKG_TARGET_EXECUTABLE_SUFFIX}")
 
+    get_property(REPORT_STARTED GLOBAL PROPERTY Z_VCPKG_FIXUP_CMAKE_TARGETS_REPORT_STARTED)
+    if(NOT REPORT_STARTED)
+        file(REMOVE "${CURRENT_BUILDTREES_DIR}/fixup-cmake-targets-${TARGET_TRIPLET}.log")
+        set_property(GLOBAL PROPERTY Z_VCPKG_FIXUP_CMAKE_TARGETS_REPORT_STARTED ON)
+    endif()
+    list(JOIN ARGV " " REPORT_ARGS)
+    z_vcpkg_fixup_cmake_targets_report("vcpkg_fixup_cmake_targets(${REPORT_ARGS})")
+
     set(DEBUG_SHARE ${CURRENT_PACKAGES_DIR}/debug/${arg_TARGET_PATH})
     set(RELEASE_SHARE ${CURRENT_PACKAGES_DIR}/${arg_TARGET_PATH})
 
@@ -96,15 +203,12 @@ function(vcpkg_fixup_cmake_targets)
             endif()
 
             # This roundabout handling enables CONFIG_PATH share
-            file(MAKE_DIRECTORY ${DEBUG_SHARE})
-            file(GLOB FILES ${DEBUG_CONFIG}/*)
-            file(COPY ${FILES} DESTINATION ${DEBUG_SHARE})
-            file(REMOVE_RECURSE ${DEBUG_CONFIG})
+            z_vcpkg_move_directory_contents(SOURCE "${DEBUG_CONFIG}" DESTINATION "${DEBUG_SHARE}")
+            z_vcpkg_fixup_cmake_targets_report("moved debug/${arg_CONFIG_PATH} to debug/${arg_TARGET_PATH}")
         endif()
 
-        file(GLOB FILES ${RELEASE_CONFIG}/*)
-        file(COPY ${FILES} DESTINATION ${RELEASE_SHARE})
-        file(REMOVE_RECURSE ${RELEASE_CONFIG})
+        z_vcpkg_move_directory_contents(SOURCE "${RELEASE_CONFIG}" DESTINATION "${RELEASE_SHARE}")
+        z_vcpkg_fixup_cmake_targets_report("moved ${arg_CONFIG_PATH} to ${arg_TARGET_PATH}")
 
         if(NOT DEFINED VCPKG_BUILD_TYPE OR VCPKG_BUILD_TYPE STREQUAL "debug")
             get_filename_component(DEBUG_CONFIG_DIR_NAME ${DEBUG_CONFIG} NAME)
@@ -147,18 +251,26 @@ function(vcpkg_fixup_cmake_targets)
         "${DEBUG_SHARE}/*[Cc]onfigVersion.cmake"
         "${DEBUG_SHARE}/*[Cc]onfig-version.cmake"
     )
+    foreach(UNUSED_FILE IN LISTS UNUSED_FILES)
+        file(RELATIVE_PATH UNUSED_FILE_REL "${CURRENT_PACKAGES_DIR}" "${UNUSED_FILE}")
+        z_vcpkg_fixup_cmake_targets_report("${UNUSED_FILE_REL}: removed")
+    endforeach()
     if(UNUSED_FILES)
         file(REMOVE ${UNUSED_FILES})
     endif()
 
-    file(GLOB_RECURSE RELEASE_TARGETS
-        "${RELEASE_SHARE}/*-release.cmake"
-    )
-    foreach(RELEASE_TARGET IN LISTS RELEASE_TARGETS)
-        file(READ ${RELEASE_TARGET} _contents)
-        string(REPLACE "${CURRENT_INSTALLED_DIR}" "\${_IMPORT_PREFIX}" _contents "${_contents}")
-        string(REGEX REPLACE "\\\${_IMPORT_PREFIX}/bin/([^ \"]+${EXECUTABLE_SUFFIX})" "\${_IMPORT_PREFIX}/${arg_TOOLS_PATH}/\\1" _contents "${_contents}")
-        file(WRITE ${RELEASE_TARGET} "${_contents}")
+    # Every file is read and written once, with all of its rewrites applied in between.
+    file(GLOB_RECURSE MAIN_CMAKES "${RELEASE_SHARE}/*.cmake")
+    foreach(MAIN_CMAKE IN LISTS MAIN_CMAKES)
+        get_filename_component(MAIN_CMAKE_DIR "${MAIN_CMAKE}" DIRECTORY)
+        set(KIND "")
+        if(MAIN_CMAKE MATCHES "-release\\.cmake$")
+            set(KIND RELEASE_TARGETS)
+        endif()
+        if(MAIN_CMAKE_DIR STREQUAL RELEASE_SHARE)
+            list(APPEND KIND TOP_LEVEL)
+        endif()
+        z_vcpkg_fixup_cmake_targets_rewrite("${MAIN_CMAKE}" "${MAIN_CMAKE}" ${KIND})
     endforeach()
 
     if(NOT DEFINED VCPKG_BUILD_TYPE OR VCPKG_BUILD_TYPE STREQUAL "debug")
@@ -167,59 +279,15 @@ function(vcpkg_fixup_cmake_targets)
             )
         foreach(DEBUG_TARGET IN LISTS DEBUG_TARGETS)
             file(RELATIVE_PATH DEBUG_TARGET_REL "${DEBUG_SHARE}" "${DEBUG_TARGET}")
-
-            file(READ ${DEBUG_TARGET} _contents)
-            string(REPLACE "${CURRENT_INSTALLED_DIR}" "\${_IMPORT_PREFIX}" _contents "${_contents}")
-            string(REGEX REPLACE "\\\${_IMPORT_PREFIX}/bin/([^ \";]+${EXECUTABLE_SUFFIX})" "\${_IMPORT_PREFIX}/${arg_TOOLS_PATH}/\\1" _contents "${_contents}")
-            string(REPLACE "\${_IMPORT_PREFIX}/lib" "\${_IMPORT_PREFIX}/debug/lib" _contents "${_contents}")
-            string(REPLACE "\${_IMPORT_PREFIX}/bin" "\${_IMPORT_PREFIX}/debug/bin" _contents "${_contents}")
-            file(WRITE ${RELEASE_SHARE}/${DEBUG_TARGET_REL} "${_contents}")
-
+            set(KIND DEBUG_TARGETS)
+            if(NOT DEBUG_TARGET_REL MATCHES "/")
+                list(APPEND KIND TOP_LEVEL)
+            endif()
+            z_vcpkg_fixup_cmake_targets_rewrite("${DEBUG_TARGET}" "${RELEASE_SHARE}/${DEBUG_TARGET_REL}" ${KIND})
             file(REMOVE ${DEBUG_TARGET})
         endforeach()
     endif()
 
-    #Fix ${_IMPORT_PREFIX} in cmake generated targets and configs;
-    #Since those can be renamed we have to check in every *.cmake
-    file(GLOB_RECURSE MAIN_CMAKES "${RELEASE_SHARE}/*.cmake")
-
-    foreach(MAIN_CMAKE IN LISTS MAIN_CMAKES)
-        file(READ ${MAIN_CMAKE} _contents)
-        #This correction is not correct for all cases. To make it correct for all cases it needs to consider
-        #original folder deepness to CURRENT_PACKAGES_DIR in comparison to the moved to folder deepness which
-        #is always at least (>=) 2, e.g. share/${PORT}. Currently the code assumes it is always 2 although
-        #this requirement is only true for the *Config.cmake. The targets are not required to be in the same
-        #folder as the *Config.cmake!
-        if(NOT arg_NO_PREFIX_CORRECTION)
-            string(REGEX REPLACE
-                "get_filename_component\\(_IMPORT_PREFIX \"\\\${CMAKE_CURRENT_LIST_FILE}\" PATH\\)(\nget_filename_component\\(_IMPORT_PREFIX \"\\\${_IMPORT_PREFIX}\" PATH\\))*"
-                "get_filename_component(_IMPORT_PREFIX \"\${CMAKE_CURRENT_LIST_FILE}\" PATH)\nget_filename_component(_IMPORT_PREFIX \"\${_IMPORT_PREFIX}\" PATH)\nget_filename_component(_IMPORT_PREFIX \"\${_IMPORT_PREFIX}\" PATH)"
-                _contents "${_contents}") # see #1044 for details why this replacement is necessary. See #4782 why it must be a regex.
-            string(REGEX REPLACE
-                "get_filename_component\\(PACKAGE_PREFIX_DIR \"\\\${CMAKE_CURRENT_LIST_DIR}/\\.\\./(\\.\\./)*\" ABSOLUTE\\)"
-                "get_filename_component(PACKAGE_PREFIX_DIR \"\${CMAKE_CURRENT_LIST_DIR}/../../\" ABSOLUTE)"
-                _contents "${_contents}")
-            string(REGEX REPLACE
-                "get_filename_component\\(PACKAGE_PREFIX_DIR \"\\\${CMAKE_CURRENT_LIST_DIR}/\\.\\.((\\\\|/)\\.\\.)*\" ABSOLUTE\\)"
-                "get_filename_component(PACKAGE_PREFIX_DIR \"\${CMAKE_CURRENT_LIST_DIR}/../../\" ABSOLUTE)"
-                _contents "${_contents}") # This is a meson-related workaround, see https://github.com/mesonbuild/meson/issues/6955
-        endif()
-
-        #Fix wrongly absolute paths to install dir with the correct dir using ${_IMPORT_PREFIX}
-        #This happens if vcpkg built libraries are directly linked to a target instead of using
-        #an imported target for it. We could add more logic here to identify defect target files.
-        #Since the replacement here in a multi config build always requires a generator expression
-        #in front of the absoulte path to ${CURRENT_INSTALLED_DIR}. So the match should always be at
-        #least >:${CURRENT_INSTALLED_DIR}.
-        #In general the following generator expressions should be there:
-        #\$<\$<CONFIG:DEBUG>:${CURRENT_INSTALLED_DIR}/debug/lib/somelib>
-        #and/or
-        #\$<\$<NOT:\$<CONFIG:DEBUG>>:${CURRENT_INSTALLED_DIR}/lib/somelib>
-        #with ${CURRENT_INSTALLED_DIR} being fully expanded
-        string(REPLACE "${CURRENT_INSTALLED_DIR}" [[${_IMPORT_PREFIX}]] _contents "${_contents}")
-        file(WRITE ${MAIN_CMAKE} "${_contents}")
-    endforeach()
-
     # Remove /debug/<target_path>/ if it's empty.
     file(GLOB_RECURSE REMAINING_FILES "${DEBUG_SHARE}/*")
     if(NOT REMAINING_FILES)
@@ -232,14 +300,7 @@ function(vcpkg_fixup_cmake_targets)
         file(REMOVE_RECURSE ${CURRENT_PACKAGES_DIR}/debug/share)
     endif()
 
-    # Patch out any remaining absolute references
-    file(TO_CMAKE_PATH "${CURRENT_PACKAGES_DIR}" CMAKE_CURRENT_PACKAGES_DIR)
-    file(GLOB CMAKE_FILES ${RELEASE_SHARE}/*.cmake)
-    foreach(CMAKE_FILE IN LISTS CMAKE_FILES)
-        file(READ ${CMAKE_FILE} _contents)
-        string(REPLACE "${CMAKE_CURRENT_PACKAGES_DIR}" "\${CMAKE_CURRENT_LIST_DIR}/../.." _contents "${_contents}")
-        file(WRITE ${CMAKE_FILE} "${_contents}")
-    endforeach()
+    z_vcpkg_timing_end(fixup "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
 
 
@@ -13,6 +13,7 @@ vcpkg_fixup_pkgconfig(
     [RELEASE_FILES <PATHS>...]
     [DEBUG_FILES <PATHS>...]
     [SKIP_CHECK]
+    [CHECK_WITH_PKGCONFIG]
 )
 ```
 
@@ -28,6 +29,10 @@ Defaults to every *.pc file in the folder ${CURRENT_PACKAGES_DIR}/debug/
 ### SKIP_CHECK
 Skips the library checks in vcpkg_fixup_pkgconfig. Only use if the script itself has unhandled cases.
 
+### CHECK_WITH_PKGCONFIG
+Runs `pkg-config --exists` for every file instead of the built-in check described below.
+This acquires pkg-config and starts one process per file, so only use it to investigate a difference between the two.
+
 ### SYSTEM_PACKAGES (deprecated)
 This argument has been deprecated and has no effect.
 
@@ -40,6 +45,14 @@ This argument has been deprecated and has no effect.
 ## Notes
 Still work in progress. If there are more cases which can be handled here feel free to add them
 
+After fixing the files, each configuration is checked the way `pkg-config --exists` would check it,
+without running pkg-config: every file and every package it requires must define the `Name`, `Description` and `Version` fields,
+only use variables that are defined, have balanced quotes in `Libs`, `Libs.private` and `Cflags`,
+and satisfy the version constraints in `Requires` and `Requires.private`.
+Required packages are searched in the `lib/pkgconfig` and `share/pkgconfig` directories of the port and of its installed dependencies,
+in `PKG_CONFIG_PATH`, and in `PKG_CONFIG_LIBDIR` or the usual system directories.
+All problems are reported together.
+
 ## Examples
 
 * [brotli](https://github.com/Microsoft/vcpkg/blob/master/ports/brotli/portfile.cmake)
@@ -93,9 +106,257 @@ function(vcpkg_fixup_pkgconfig_check_files pkg_cfg_cmd _file _config)
     endif()
 endfunction()
 
+function(z_vcpkg_fixup_pkgconfig_expand out_var value)
+    # Expands ${name} references with the var_<name> variables of the calling function.
+    string(REPLACE "$$" "" value "${value}")
+    set(errors "")
+    set(iterations 0)
+    while(value MATCHES "\\$\\{([^}]*)\\}" AND iterations LESS "100")
+        set(name "${CMAKE_MATCH_1}")
+        if(DEFINED "var_${name}")
+            string(REPLACE "\${${name}}" "${var_${name}}" value "${value}")
+        else()
+            list(APPEND errors "variable '${name}' is not defined")
+            string(REPLACE "\${${name}}" "" value "${value}")
+        endif()
+        math(EXPR iterations "${iterations} + 1")
+    endwhile()
+    if(NOT iterations LESS "100")
+        list(APPEND errors "the variables reference each other recursively")
+    endif()
+    set("${out_var}" "${value}" PARENT_SCOPE)
+    set("${out_var}_ERRORS" "${errors}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_fixup_pkgconfig_parse out_prefix pc_file)
+    file(READ "${pc_file}" contents)
+    # The contents are only validated, so characters with a meaning in CMake lists can be dropped.
+    string(REGEX REPLACE "[][;]" " " contents "${contents}")
+    string(REPLACE "\r" "" contents "${contents}")
+    string(REPLACE "\\\n" " " contents "${contents}")
+    string(REPLACE "\n" ";" lines "${contents}")
+
+    get_filename_component(var_pcfiledir "${pc_file}" DIRECTORY)
+    set(var_pc_sysrootdir "/")
+    set(var_pc_top_builddir "$(top_builddir)")
+    set(fields "")
+    foreach(line IN LISTS lines)
+        string(REGEX REPLACE "(^|[^\\])#.*$" "\\1" line "${line}")
+        if(NOT line MATCHES "^[ \t]*([A-Za-z0-9_.]+)[ \t]*([:=])[ \t]*(.*)$")
+            continue()
+        endif()
+        set(name "${CMAKE_MATCH_1}")
+        string(STRIP "${CMAKE_MATCH_3}" value)
+        if(CMAKE_MATCH_2 STREQUAL "=")
+            set("var_${name}" "${value}")
+        else()
+            string(TOLOWER "${name}" name)
+            set("field_${name}" "${value}")
+            list(APPEND fields "${name}")
+        endif()
+    endforeach()
+
+    set(errors "")
+    foreach(field IN ITEMS name description version)
+        if(NOT field IN_LIST fields)
+            string(SUBSTRING "${field}" 0 1 first)
+            string(SUBSTRING "${field}" 1 -1 rest)
+            string(TOUPPER "${first}" first)
+            list(APPEND errors "missing the '${first}${rest}' field")
+        endif()
+    endforeach()
+    foreach(field IN LISTS fields)
+        z_vcpkg_fixup_pkgconfig_expand(value "${field_${field}}")
+        foreach(error IN LISTS value_ERRORS)
+            list(APPEND errors "${error}")
+        endforeach()
+        set("field_${field}" "${value}")
+        if(field MATCHES "^(libs|libs\\.private|cflags)$")
+            string(REPLACE "\\\"" "" unescaped "${value}")
+            string(REGEX REPLACE "[^\"]" "" quotes "${unescaped}")
+            string(LENGTH "${quotes}" quote_count)
+            math(EXPR odd "${quote_count} % 2")
+            if(odd)
+                list(APPEND errors "unbalanced quotes in the '${field}' field")
+            endif()
+        endif()
+    endforeach()
+
+    foreach(field IN ITEMS requires requires.private)
+        set(requirements "")
+        # Entries are separated by commas or whitespace, and may be followed by a version constraint.
+        string(REPLACE "," " " tokens "${field_${field}}")
+        # pkg-config also accepts operators without whitespace around them, as in `foo>=1.0`.
+        string(REGEX REPLACE "(<=|>=|!=|<|>|=)" " \\1 " tokens "${tokens}")
+        string(REGEX REPLACE "[ \t]+" ";" tokens "${tokens}")
+        list(REMOVE_ITEM tokens "")
+        while(NOT tokens STREQUAL "")
+            list(POP_FRONT tokens package)
+            set(constraint "")
+            list(LENGTH tokens remaining)
+            if(remaining GREATER_EQUAL "2")
+                list(GET tokens 0 operator)
+                if(operator MATCHES "^(<|<=|=|!=|>=|>)$")
+                    list(GET tokens 1 required_version)
+                    list(REMOVE_AT tokens 0 1)
+                    set(constraint " ${operator} ${required_version}")
+                endif()
+            endif()
+            list(APPEND requirements "${package}${constraint}")
+        endwhile()
+        set("${out_prefix}_${field}" "${requirements}" PARENT_SCOPE)
+    endforeach()
+    set("${out_prefix}_version" "${field_version}" PARENT_SCOPE)
+    set("${out_prefix}_errors" "${errors}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_fixup_pkgconfig_compare_versions out_var lhs rhs)
+    # Same ordering as pkg-config: alternating runs of digits and letters are compared one by one,
+    # numerically or alphabetically, and a number is newer than letters.
+    set(result 0)
+    string(REGEX MATCHALL "[0-9]+|[A-Za-z]+" lhs_segments "${lhs}")
+    string(REGEX MATCHALL "[0-9]+|[A-Za-z]+" rhs_segments "${rhs}")
+    while(result EQUAL "0")
+        if(lhs_segments STREQUAL "" OR rhs_segments STREQUAL "")
+            if(NOT lhs_segments STREQUAL "")
+                set(result 1)
+            elseif(NOT rhs_segments STREQUAL "")
+                set(result -1)
+            endif()
+            break()
+        endif()
+        list(POP_FRONT lhs_segments lhs_segment)
+        list(POP_FRONT rhs_segments rhs_segment)
+        if(lhs_segment MATCHES "^[0-9]" AND rhs_segment MATCHES "^[0-9]")
+            string(REGEX REPLACE "^0+" "" lhs_segment "${lhs_segment}")
+            string(REGEX REPLACE "^0+" "" rhs_segment "${rhs_segment}")
+            string(LENGTH "${lhs_segment}" lhs_length)
+            string(LENGTH "${rhs_segment}" rhs_length)
+            if(lhs_length GREATER rhs_length)
+                set(result 1)
+            elseif(lhs_length LESS rhs_length)
+                set(result -1)
+            endif()
+        elseif(lhs_segment MATCHES "^[0-9]")
+            set(result 1)
+        elseif(rhs_segment MATCHES "^[0-9]")
+            set(result -1)
+        endif()
+        if(result EQUAL "0")
+            if(lhs_segment STRGREATER rhs_segment)
+                set(result 1)
+            elseif(lhs_segment STRLESS rhs_segment)
+                set(result -1)
+            endif()
+        endif()
+    endwhile()
+    set("${out_var}" "${result}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_fixup_pkgconfig_check_all_files config)
+    # Validates all given .pc files and everything they require, the way `pkg-config --exists` would,
+    # but without starting a process per file; all problems are reported together.
+    set(path_suffix_DEBUG "/debug")
+    set(path_suffix_RELEASE "")
+    set(search_dirs
+        "${CURRENT_PACKAGES_DIR}${path_suffix_${config}}/lib/pkgconfig"
+        "${CURRENT_PACKAGES_DIR}/share/pkgconfig"
+        "${CURRENT_INSTALLED_DIR}${path_suffix_${config}}/lib/pkgconfig"
+        "${CURRENT_INSTALLED_DIR}/share/pkgconfig"
+    )
+    if(DEFINED ENV{PKG_CONFIG_PATH})
+        string(REPLACE "${VCPKG_HOST_PATH_SEPARATOR}" ";" env_dirs "$ENV{PKG_CONFIG_PATH}")
+        list(APPEND search_dirs ${env_dirs})
+    endif()
+    if(DEFINED ENV{PKG_CONFIG_LIBDIR})
+        string(REPLACE "${VCPKG_HOST_PATH_SEPARATOR}" ";" env_dirs "$ENV{PKG_CONFIG_LIBDIR}")
+        list(APPEND search_dirs ${env_dirs})
+    elseif(NOT CMAKE_HOST_WIN32)
+        # The usual default search path of pkg-config, for ports which require system packages
+        file(GLOB system_dirs LIST_DIRECTORIES true
+            "/usr/lib*/pkgconfig" "/usr/lib/*/pkgconfig" "/usr/share/pkgconfig"
+            "/usr/local/lib*/pkgconfig" "/usr/local/lib/*/pkgconfig" "/usr/local/share/pkgconfig"
+            "/opt/homebrew/lib/pkgconfig" "/opt/homebrew/share/pkgconfig"
+        )
+        list(APPEND search_dirs ${system_dirs})
+    endif()
+
+    set(queue "")
+    foreach(pc_file IN LISTS ARGN)
+        get_filename_component(package "${pc_file}" NAME_WLE)
+        set("pc_${package}_file" "${pc_file}")
+        list(APPEND queue "${package}")
+    endforeach()
+
+    set(errors "")
+    set(visited "")
+    set(version_checks "")
+    while(NOT queue STREQUAL "")
+        list(POP_FRONT queue package)
+        if(package IN_LIST visited)
+            continue()
+        endif()
+        list(APPEND visited "${package}")
+        set(pc_file "${pc_${package}_file}")
+        debug_message("Checking package (${config}): ${package}")
+        z_vcpkg_fixup_pkgconfig_parse("pc_${package}" "${pc_file}")
+        foreach(error IN LISTS "pc_${package}_errors")
+            list(APPEND errors "${pc_file}: ${error}")
+        endforeach()
+
+        foreach(requirement IN LISTS "pc_${package}_requires" "pc_${package}_requires.private")
+            string(REPLACE " " ";" requirement "${requirement}")
+            list(GET requirement 0 required_package)
+            if(NOT DEFINED "pc_${required_package}_file")
+                foreach(dir IN LISTS search_dirs)
+                    if(EXISTS "${dir}/${required_package}.pc")
+                        set("pc_${required_package}_file" "${dir}/${required_package}.pc")
+                        break()
+                    endif()
+                endforeach()
+            endif()
+            if(NOT DEFINED "pc_${required_package}_file")
+                list(APPEND errors "${pc_file}: required package '${required_package}' was not found")
+                continue()
+            endif()
+            list(APPEND queue "${required_package}")
+            list(LENGTH requirement requirement_length)
+            if(requirement_length EQUAL "3")
+                list(JOIN requirement " " requirement)
+                list(APPEND version_checks "${package} ${requirement}")
+            endif()
+        endforeach()
+    endwhile()
+
+    foreach(version_check IN LISTS version_checks)
+        string(REPLACE " " ";" version_check "${version_check}")
+        list(GET version_check 0 package)
+        list(GET version_check 1 required_package)
+        list(GET version_check 2 operator)
+        list(GET version_check 3 required_version)
+        set(actual_version "${pc_${required_package}_version}")
+        z_vcpkg_fixup_pkgconfig_compare_versions(comparison "${actual_version}" "${required_version}")
+        if(NOT (operator STREQUAL "=" AND comparison EQUAL "0")
+            AND NOT (operator STREQUAL "!=" AND NOT comparison EQUAL "0")
+            AND NOT (operator STREQUAL "<" AND comparison LESS "0")
+            AND NOT (operator STREQUAL "<=" AND comparison LESS_EQUAL "0")
+            AND NOT (operator STREQUAL ">" AND comparison GREATER "0")
+            AND NOT (operator STREQUAL ">=" AND comparison GREATER_EQUAL "0"))
+            list(APPEND errors "${pc_${package}_file}: requires '${required_package} ${operator} ${required_version}', but version '${actual_version}' of ${pc_${required_package}_file} was found")
+        endif()
+    endforeach()
+
+    if(NOT errors STREQUAL "")
+        list(JOIN errors "\n    " errors)
+        message(FATAL_ERROR "The ${config} pkg-config files are not usable:\n    ${errors}\n"
+            "Pass CHECK_WITH_PKGCONFIG to vcpkg_fixup_pkgconfig() to compare with the result of pkg-config itself.")
+    endif()
+endfunction()
+
 function(vcpkg_fixup_pkgconfig)
+    z_vcpkg_timing_begin(fixup)
     # parse parameters such that semicolons in options arguments to COMMAND don't get erased
-    cmake_parse_arguments(PARSE_ARGV 0 _vfpkg "SKIP_CHECK" "" "RELEASE_FILES;DEBUG_FILES;SYSTEM_LIBRARIES;SYSTEM_PACKAGES;IGNORE_FLAGS")
+    cmake_parse_arguments(PARSE_ARGV 0 _vfpkg "SKIP_CHECK;CHECK_WITH_PKGCONFIG" "" "RELEASE_FILES;DEBUG_FILES;SYSTEM_LIBRARIES;SYSTEM_PACKAGES;IGNORE_FLAGS")
 
     if(_vfpkg_UNPARSED_ARGUMENTS)
         message(FATAL_ERROR "vcpkg_fixup_pkgconfig() was passed extra arguments: ${_vfct_UNPARSED_ARGUMENTS}")
@@ -113,8 +374,10 @@ function(vcpkg_fixup_pkgconfig)
         endif()
     endif()
 
-    vcpkg_find_acquire_program(PKGCONFIG)
-    debug_message("Using pkg-config from: ${PKGCONFIG}")
+    if(_vfpkg_CHECK_WITH_PKGCONFIG AND NOT _vfpkg_SKIP_CHECK)
+        vcpkg_find_acquire_program(PKGCONFIG)
+        debug_message("Using pkg-config from: ${PKGCONFIG}")
+    endif()
 
     #Absolute Unix like paths 
     string(REGEX REPLACE "([a-zA-Z]):/" "/\\1/" _VCPKG_PACKAGES_DIR "${CURRENT_PACKAGES_DIR}")
@@ -179,10 +442,13 @@ function(vcpkg_fixup_pkgconfig)
             unset(PKG_LIB_SEARCH_PATH)
         endforeach()
 
-        if(NOT _vfpkg_SKIP_CHECK) # The check can only run after all files have been corrected!
+        if(_vfpkg_SKIP_CHECK) # The check can only run after all files have been corrected!
+        elseif(_vfpkg_CHECK_WITH_PKGCONFIG)
             foreach(_file ${_vfpkg_${CONFIG}_FILES})
                 vcpkg_fixup_pkgconfig_check_files("${PKGCONFIG}" "${_file}" "${CONFIG}")
             endforeach()
+        elseif(NOT "${_vfpkg_${CONFIG}_FILES}" STREQUAL "")
+            z_vcpkg_fixup_pkgconfig_check_all_files("${CONFIG}" ${_vfpkg_${CONFIG}_FILES})
         endif()
     endforeach()
     debug_message("Fixing pkgconfig --- finished")
@@ -192,4 +458,5 @@ function(vcpkg_fixup_pkgconfig)
     # Theoreotically vcpkg could look for *.pc files and automatically call this function
     # or check if this function has been called if *.pc files are detected.
     # The same is true for vcpkg_fixup_cmake_targets
+    z_vcpkg_timing_end(fixup "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
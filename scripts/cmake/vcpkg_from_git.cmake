@@ -39,6 +39,12 @@ Relative paths are based on the port directory.
 ## Notes:
 `OUT_SOURCE_PATH`, `REF`, and `URL` must be specified.
 
+Commits are fetched into a bare repository in `downloads/git-mirrors` that is shared by all ports using the same `URL`.
+Each fetched ref is kept below `refs/vcpkg/` in that repository, so that `git gc` does not prune it.
+If `REF` has already been fetched from that `URL`, it is archived from there without contacting the server;
+otherwise the server can skip sending the objects that the mirror already has.
+Builds running at the same time take turns fetching into a mirror.
+
 ## Examples:
 
 * [fdlibm](https://github.com/Microsoft/vcpkg/blob/master/ports/fdlibm/portfile.cmake)
@@ -46,7 +52,18 @@ Relative paths are based on the port directory.
 
 include(vcpkg_execute_in_download_mode)
 
+function(z_vcpkg_from_git_mirror_path out_var url)
+    string(REGEX REPLACE "/+$" "" name "${url}")
+    string(REGEX REPLACE "^.*[/:]" "" name "${name}")
+    string(REGEX REPLACE "\\.git$" "" name "${name}")
+    string(REGEX REPLACE "[^A-Za-z0-9_.-]" "_" name "${name}")
+    string(SHA512 url_hash "${url}")
+    string(SUBSTRING "${url_hash}" 0 16 url_hash)
+    set("${out_var}" "${DOWNLOADS}/git-mirrors/${name}-${url_hash}.git" PARENT_SCOPE)
+endfunction()
+
 function(vcpkg_from_git)
+    z_vcpkg_timing_begin(download)
     cmake_parse_arguments(PARSE_ARGV 0 "arg"
         ""
         "OUT_SOURCE_PATH;URL;REF;HEAD_REF;TAG"
@@ -85,6 +102,14 @@ function(vcpkg_from_git)
     endif()
 
     string(REPLACE "/" "_-" sanitized_ref "${ref_to_use}")
+    if(DEFINED Z_VCPKG_PREFETCH_COLLECT)
+        # The collection pass of z_vcpkg_prefetch_downloads() does not fetch from git.
+        set("${arg_OUT_SOURCE_PATH}" "${CURRENT_BUILDTREES_DIR}/src/${sanitized_ref}" PARENT_SCOPE)
+        z_vcpkg_timing_end(download "${CMAKE_CURRENT_FUNCTION}")
+        return()
+    endif()
+    # keeps the fetched commit reachable in the mirror, and tells later fetches which objects the mirror has
+    set(mirror_ref "refs/vcpkg/${sanitized_ref}")
     set(temp_archive "${DOWNLOADS}/temp/${PORT}-${sanitized_ref}.tar.gz")
     set(archive "${DOWNLOADS}/${PORT}-${sanitized_ref}.tar.gz")
 
@@ -92,32 +117,57 @@ function(vcpkg_from_git)
         if(_VCPKG_NO_DOWNLOADS)
             message(FATAL_ERROR "Downloads are disabled, but '${archive}' does not exist.")
         endif()
-        message(STATUS "Fetching ${arg_URL} ${ref_to_use}...")
         find_program(GIT NAMES git git.cmd)
-        file(MAKE_DIRECTORY "${DOWNLOADS}")
+        z_vcpkg_from_git_mirror_path(mirror "${arg_URL}")
+        file(MAKE_DIRECTORY "${DOWNLOADS}/git-mirrors")
+        file(LOCK "${mirror}.lock" GUARD FUNCTION)
         # Note: git init is safe to run multiple times
         vcpkg_execute_required_process(
             ALLOW_IN_DOWNLOAD_MODE
-            COMMAND "${GIT}" init git-tmp
-            WORKING_DIRECTORY "${DOWNLOADS}"
+            COMMAND "${GIT}" init --bare "${mirror}"
+            WORKING_DIRECTORY "${DOWNLOADS}/git-mirrors"
             LOGNAME "git-init-${TARGET_TRIPLET}"
         )
-        vcpkg_execute_required_process(
-            ALLOW_IN_DOWNLOAD_MODE
-            COMMAND "${GIT}" fetch "${arg_URL}" "${ref_to_use}" --depth 1 -n
-            WORKING_DIRECTORY "${DOWNLOADS}/git-tmp"
-            LOGNAME "git-fetch-${TARGET_TRIPLET}"
-        )
-        vcpkg_execute_in_download_mode(
-            COMMAND "${GIT}" rev-parse FETCH_HEAD
-            OUTPUT_VARIABLE rev_parse_head
-            ERROR_VARIABLE rev_parse_head
-            RESULT_VARIABLE error_code
-            WORKING_DIRECTORY "${DOWNLOADS}/git-tmp"
-        )
-        if(error_code)
-            message(FATAL_ERROR "unable to determine FETCH_HEAD after fetching git repository")
+
+        set(rev_parse_head "")
+        if(NOT VCPKG_USE_HEAD_VERSION)
+            # REF is a commit; if an earlier build already fetched it from this URL, reuse it
+            vcpkg_execute_in_download_mode(
+                COMMAND "${GIT}" rev-parse --verify --quiet "${mirror_ref}^{commit}"
+                OUTPUT_VARIABLE rev_parse_head
+                ERROR_QUIET
+                RESULT_VARIABLE error_code
+                WORKING_DIRECTORY "${mirror}"
+            )
+            if(error_code)
+                set(rev_parse_head "")
+            endif()
+        endif()
+
+        if(rev_parse_head STREQUAL "")
+            message(STATUS "Fetching ${arg_URL} ${ref_to_use}...")
+            vcpkg_execute_required_process(
+                ALLOW_IN_DOWNLOAD_MODE
+                COMMAND "${GIT}" fetch "${arg_URL}" "+${ref_to_use}:${mirror_ref}" --depth 1 -n
+                WORKING_DIRECTORY "${mirror}"
+                LOGNAME "git-fetch-${TARGET_TRIPLET}"
+            )
+            vcpkg_execute_in_download_mode(
+                COMMAND "${GIT}" rev-parse "${mirror_ref}^{commit}"
+                OUTPUT_VARIABLE rev_parse_head
+                ERROR_VARIABLE rev_parse_head
+                RESULT_VARIABLE error_code
+                WORKING_DIRECTORY "${mirror}"
+            )
+            if(error_code)
+                message(FATAL_ERROR "unable to determine ${mirror_ref} after fetching git repository")
+            endif()
+        else()
+            message(STATUS "Using ${ref_to_use} from the git mirror of ${arg_URL}")
         endif()
+        # Other builds may fetch into the mirror while this one archives from it
+        file(LOCK "${mirror}.lock" RELEASE)
+
         string(STRIP "${rev_parse_head}" rev_parse_head)
         if(VCPKG_USE_HEAD_VERSION)
             set(VCPKG_HEAD_VERSION "${rev_parse_head}" PARENT_SCOPE)
@@ -132,7 +182,7 @@ function(vcpkg_from_git)
         vcpkg_execute_required_process(
             ALLOW_IN_DOWNLOAD_MODE
             COMMAND "${GIT}" archive "${rev_parse_head}" -o "${temp_archive}"
-            WORKING_DIRECTORY "${DOWNLOADS}/git-tmp"
+            WORKING_DIRECTORY "${mirror}"
             LOGNAME git-archive
         )
         file(RENAME "${temp_archive}" "${archive}")
@@ -150,4 +200,5 @@ function(vcpkg_from_git)
     )
 
     set("${arg_OUT_SOURCE_PATH}" "${SOURCE_PATH}" PARENT_SCOPE)
+    z_vcpkg_timing_end(download "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -25,6 +25,7 @@ parameter.
 #]===]
 
 function(vcpkg_install_cmake)
+    z_vcpkg_timing_begin(install)
     if(Z_VCPKG_CMAKE_INSTALL_GUARD)
         message(FATAL_ERROR "The ${PORT} port already depends on vcpkg-cmake; using both vcpkg-cmake and vcpkg_install_cmake in the same port is unsupported.")
     endif()
@@ -46,4 +47,5 @@ function(vcpkg_install_cmake)
         LOGFILE_ROOT install
         TARGET install
     )
+    z_vcpkg_timing_end(install "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -107,6 +107,7 @@ function(z_vcpkg_install_gn_install)
 endfunction()
 
 function(vcpkg_install_gn)
+    z_vcpkg_timing_begin(install)
     cmake_parse_arguments(PARSE_ARGV 0 arg "" "SOURCE_PATH" "TARGETS")
 
     if(DEFINED arg_UNPARSED_ARGUMENTS)
@@ -137,4 +138,5 @@ function(vcpkg_install_gn)
             TARGETS ${arg_TARGETS}
         )
     endif()
+    z_vcpkg_timing_end(install "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
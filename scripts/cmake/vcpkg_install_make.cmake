@@ -23,5 +23,7 @@ This command transparently forwards to [`vcpkg_build_make()`](vcpkg_build_make.m
 #]===]
 
 function(vcpkg_install_make)
+    z_vcpkg_timing_begin(install)
     vcpkg_build_make(${ARGN} LOGFILE_ROOT ENABLE_INSTALL)
+    z_vcpkg_timing_end(install "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -19,6 +19,7 @@ Adds the appropriate Release and Debug `bin\` directories to the path during the
 #]===]
 
 function(vcpkg_install_meson)
+    z_vcpkg_timing_begin(install)
     vcpkg_find_acquire_program(NINJA)
     unset(ENV{DESTDIR}) # installation directory was already specified with '--prefix' option
     cmake_parse_arguments(PARSE_ARGV 0 _im "ADD_BIN_TO_PATH" "" "")
@@ -102,4 +103,5 @@ function(vcpkg_install_meson)
             unset(ENV{MACOSX_DEPLOYMENT_TARGET})
         endif()
     endif()
+    z_vcpkg_timing_end(install "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -92,6 +92,7 @@ Additional options passed to msbuild for Debug builds. These are in addition to
 #]===]
 
 function(vcpkg_install_msbuild)
+    z_vcpkg_timing_begin(install)
     cmake_parse_arguments(
         PARSE_ARGV 0
         "arg"
@@ -242,4 +243,5 @@ function(vcpkg_install_msbuild)
             RENAME copyright
         )
     endif()
+    z_vcpkg_timing_end(install "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -65,6 +65,7 @@ This command transparently forwards to [`vcpkg_build_nmake()`](vcpkg_build_nmake
 #]===]
 
 function(vcpkg_install_nmake)
+    z_vcpkg_timing_begin(install)
     # parse parameters such that semicolons in options arguments to COMMAND don't get erased
     cmake_parse_arguments(PARSE_ARGV 0 _in
         "NO_DEBUG"
@@ -93,4 +94,5 @@ function(vcpkg_install_nmake)
         PRERUN_SHELL ${_in_PRERUN_SHELL} PRERUN_SHELL_DEBUG ${_in_PRERUN_SHELL_DEBUG} PRERUN_SHELL_RELEASE ${_in_PRERUN_SHELL_RELEASE}
         OPTIONS ${_in_OPTIONS} OPTIONS_RELEASE ${_in_OPTIONS_RELEASE} OPTIONS_DEBUG ${_in_OPTIONS_DEBUG}
     )
+    z_vcpkg_timing_end(install "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
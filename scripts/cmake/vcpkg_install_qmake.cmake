@@ -23,6 +23,7 @@ staging directories.
 #]===]
 
 function(vcpkg_install_qmake)
+    z_vcpkg_timing_begin(install)
     vcpkg_build_qmake(${ARGN})
     file(GLOB_RECURSE RELEASE_LIBS
         ${CURRENT_BUILDTREES_DIR}/${TARGET_TRIPLET}-rel/*.lib
@@ -63,4 +64,5 @@ function(vcpkg_install_qmake)
         file(MAKE_DIRECTORY ${CURRENT_PACKAGES_DIR}/debug/bin)
         file(COPY ${DEBUG_BINS} DESTINATION ${CURRENT_PACKAGES_DIR}/debug/bin)
     endif()
+    z_vcpkg_timing_end(install "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
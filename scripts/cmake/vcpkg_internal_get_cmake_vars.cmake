@@ -22,11 +22,55 @@ Variable to return the path to the generated cmake file with the detected `CMAKE
 ## Notes
 If possible avoid usage in portfiles. 
 
+The detected variables only depend on the triplet settings, toolchain files and environment,
+so they are cached in `buildtrees/_cmake_vars`, keyed on a hash of those inputs.
+Ports building for the same triplet in the same environment reuse the cached results
+instead of configuring `scripts/get_cmake_vars` again.
+
 ## Examples
 
 * [vcpkg_configure_make](https://github.com/Microsoft/vcpkg/blob/master/scripts/cmake/vcpkg_configure_make.cmake)
 #]===]
 
+# Hashes everything the results of configuring scripts/get_cmake_vars depend on.
+function(z_vcpkg_get_cmake_vars_cache_key out_var)
+    set(key_inputs "${ARGN}")
+    foreach(var IN ITEMS TARGET_TRIPLET CURRENT_INSTALLED_DIR _VCPKG_INSTALLED_DIR VCPKG_ROOT_DIR CMAKE_COMMAND CMAKE_VERSION)
+        list(APPEND key_inputs "${var}=${${var}}")
+    endforeach()
+    # This covers the triplet settings, including any per-port customizations.
+    get_cmake_property(all_variables VARIABLES)
+    foreach(var IN LISTS all_variables)
+        if(var MATCHES "^VCPKG_" AND NOT var MATCHES "^VCPKG_(POLICY|DETECTED)_")
+            list(APPEND key_inputs "${var}=${${var}}")
+        endif()
+    endforeach()
+
+    file(GLOB toolchain_files "${SCRIPTS}/toolchains/*.cmake")
+    foreach(file IN LISTS toolchain_files VCPKG_CHAINLOAD_TOOLCHAIN_FILE ITEMS
+            "${SCRIPTS}/buildsystems/vcpkg.cmake"
+            "${SCRIPTS}/get_cmake_vars/CMakeLists.txt"
+            "${SCRIPTS}/cmake/vcpkg_configure_cmake.cmake")
+        if(EXISTS "${file}")
+            file(SHA512 "${file}" file_hash)
+            list(APPEND key_inputs "${file}=${file_hash}")
+        endif()
+    endforeach()
+
+    # Compiler detection may depend on any environment variable (PATH, CC, INCLUDE, SDKROOT, ...)
+    execute_process(
+        COMMAND "${CMAKE_COMMAND}" -E environment
+        OUTPUT_VARIABLE environment
+    )
+    # ...except for those that only describe the invoking shell
+    string(REGEX REPLACE "(^|\n)(PWD|OLDPWD|SHLVL|_)=[^\n]*" "" environment "${environment}")
+    list(APPEND key_inputs "${environment}")
+
+    string(SHA512 key "${key_inputs}")
+    string(SUBSTRING "${key}" 0 16 key)
+    set("${out_var}" "${key}" PARENT_SCOPE)
+endfunction()
+
 function(vcpkg_internal_get_cmake_vars)
     cmake_parse_arguments(PARSE_ARGV 0 _gcv "" "OUTPUT_FILE" "OPTIONS")
 
@@ -46,23 +90,49 @@ function(vcpkg_internal_get_cmake_vars)
         set(${_gcv_OUTPUT_FILE} "${DEFAULT_OUT}")
     endif()
 
-    vcpkg_configure_cmake(
-        SOURCE_PATH "${SCRIPTS}/get_cmake_vars"
-        OPTIONS ${_gcv_OPTIONS} "-DVCPKG_BUILD_TYPE=${VCPKG_BUILD_TYPE}"
-        OPTIONS_DEBUG "-DVCPKG_OUTPUT_FILE:PATH=${CURRENT_BUILDTREES_DIR}/cmake-vars-${TARGET_TRIPLET}-dbg.cmake.log"
-        OPTIONS_RELEASE "-DVCPKG_OUTPUT_FILE:PATH=${CURRENT_BUILDTREES_DIR}/cmake-vars-${TARGET_TRIPLET}-rel.cmake.log"
-        PREFER_NINJA
-        LOGNAME get-cmake-vars-${TARGET_TRIPLET}
-        Z_VCPKG_IGNORE_UNUSED_VARIABLES
-    )
-
-    set(_include_string)
+    set(_vars_files)
     if(NOT DEFINED VCPKG_BUILD_TYPE OR VCPKG_BUILD_TYPE STREQUAL "release")
-        string(APPEND _include_string "include(\"${CURRENT_BUILDTREES_DIR}/cmake-vars-${TARGET_TRIPLET}-rel.cmake.log\")\n")
+        list(APPEND _vars_files "cmake-vars-${TARGET_TRIPLET}-rel.cmake.log")
     endif()
     if(NOT DEFINED VCPKG_BUILD_TYPE OR VCPKG_BUILD_TYPE STREQUAL "debug")
-        string(APPEND _include_string "include(\"${CURRENT_BUILDTREES_DIR}/cmake-vars-${TARGET_TRIPLET}-dbg.cmake.log\")\n")
+        list(APPEND _vars_files "cmake-vars-${TARGET_TRIPLET}-dbg.cmake.log")
+    endif()
+
+    z_vcpkg_get_cmake_vars_cache_key(_cache_key ${_gcv_OPTIONS})
+    cmake_path(GET CURRENT_BUILDTREES_DIR PARENT_PATH _buildtrees_root)
+    set(_cache_dir "${_buildtrees_root}/_cmake_vars/${TARGET_TRIPLET}-${_cache_key}")
+
+    # Ports of the same triplet may be built concurrently; the first one to get here fills the cache for the rest.
+    file(MAKE_DIRECTORY "${_buildtrees_root}/_cmake_vars")
+    file(LOCK "${_cache_dir}.lock" GUARD FUNCTION)
+    if(EXISTS "${_cache_dir}")
+        message(STATUS "Using cached CMake variables for ${TARGET_TRIPLET} from ${_cache_dir}")
+        foreach(_vars_file IN LISTS _vars_files)
+            # Keep a copy in the port's buildtree so that it gets included in CI artifacts.
+            file(COPY "${_cache_dir}/${_vars_file}" DESTINATION "${CURRENT_BUILDTREES_DIR}")
+        endforeach()
+    else()
+        vcpkg_configure_cmake(
+            SOURCE_PATH "${SCRIPTS}/get_cmake_vars"
+            OPTIONS ${_gcv_OPTIONS} "-DVCPKG_BUILD_TYPE=${VCPKG_BUILD_TYPE}"
+            OPTIONS_DEBUG "-DVCPKG_OUTPUT_FILE:PATH=${CURRENT_BUILDTREES_DIR}/cmake-vars-${TARGET_TRIPLET}-dbg.cmake.log"
+            OPTIONS_RELEASE "-DVCPKG_OUTPUT_FILE:PATH=${CURRENT_BUILDTREES_DIR}/cmake-vars-${TARGET_TRIPLET}-rel.cmake.log"
+            PREFER_NINJA
+            LOGNAME get-cmake-vars-${TARGET_TRIPLET}
+            Z_VCPKG_IGNORE_UNUSED_VARIABLES
+        )
+        file(REMOVE_RECURSE "${_cache_dir}.tmp")
+        foreach(_vars_file IN LISTS _vars_files)
+            file(COPY "${CURRENT_BUILDTREES_DIR}/${_vars_file}" DESTINATION "${_cache_dir}.tmp")
+        endforeach()
+        file(RENAME "${_cache_dir}.tmp" "${_cache_dir}")
     endif()
+    file(LOCK "${_cache_dir}.lock" RELEASE)
+
+    set(_include_string)
+    foreach(_vars_file IN LISTS _vars_files)
+        string(APPEND _include_string "include(\"${CURRENT_BUILDTREES_DIR}/${_vars_file}\")\n")
+    endforeach()
     file(WRITE "${${_gcv_OUTPUT_FILE}}" "${_include_string}")
 
 endfunction()
@@ -26,9 +26,16 @@ One may also download patches and use `${VCPKG_DOWNLOADS}/path/to/some.patch`.
 If `QUIET` is not passed, it is a fatal error for a patch to fail to apply;
 otherwise, if `QUIET` is passed, no message is printed.
 This should only be used for edge cases, such as patches that are known to fail even on a clean source tree.
+
+Unless `QUIET` is passed, the whole series is first applied with a single `git apply`;
+only if that fails are the patches applied one by one to find the one that does not apply.
+Whether each patch was applied is recorded in `${CURRENT_BUILDTREES_DIR}/patch-${TARGET_TRIPLET}-results.log`.
+To also skip patching on rebuilds, see `VCPKG_CACHE_EXTRACTED_SOURCES`,
+which caches patched source trees by the hash of the archive and the patches.
 #]===]
 
 function(z_vcpkg_apply_patches)
+    z_vcpkg_timing_begin(patch)
     cmake_parse_arguments(PARSE_ARGV 0 "arg" "QUIET" "SOURCE_PATH" "PATCHES")
 
     if(DEFINED arg_UNPARSED_ARGUMENTS)
@@ -43,29 +50,81 @@ function(z_vcpkg_apply_patches)
     endif()
 
     set(ENV{GIT_CONFIG_NOSYSTEM} 1)
-    set(patchnum 0)
+    set(git_apply_command "${GIT}" -c core.longpaths=true -c core.autocrlf=false --work-tree=. --git-dir=.git
+        apply --ignore-whitespace --whitespace=nowarn --verbose)
+    set(absolute_patches "")
     foreach(patch IN LISTS arg_PATCHES)
         get_filename_component(absolute_patch "${patch}" ABSOLUTE BASE_DIR "${CURRENT_PORT_DIR}")
-        message(STATUS "Applying patch ${patch}")
-        set(logname "patch-${TARGET_TRIPLET}-${patchnum}")
+        list(APPEND absolute_patches "${absolute_patch}")
+    endforeach()
+    set(results_log "${CURRENT_BUILDTREES_DIR}/patch-${TARGET_TRIPLET}-results.log")
+    file(REMOVE "${results_log}")
+
+    # git apply only checks a single input as a whole before writing anything, so the series is
+    # concatenated into one patch; if it does not apply, the tree is unchanged and the patches are
+    # applied one at a time below to find out which of them fail.
+    set(batch_applied OFF)
+    list(LENGTH absolute_patches patch_count)
+    if(patch_count GREATER "1" AND NOT arg_QUIET)
+        set(logname "patch-${TARGET_TRIPLET}-all")
+        set(series_patch "${CURRENT_BUILDTREES_DIR}/${logname}.patch")
+        file(WRITE "${series_patch}" "")
+        foreach(absolute_patch IN LISTS absolute_patches)
+            file(READ "${absolute_patch}" contents)
+            if(NOT contents MATCHES "\n$")
+                string(APPEND contents "\n")
+            endif()
+            file(APPEND "${series_patch}" "${contents}")
+        endforeach()
         vcpkg_execute_in_download_mode(
-            COMMAND "${GIT}" -c core.longpaths=true -c core.autocrlf=false --work-tree=. --git-dir=.git apply "${absolute_patch}" --ignore-whitespace --whitespace=nowarn --verbose
+            COMMAND ${git_apply_command} "${series_patch}"
             OUTPUT_FILE "${CURRENT_BUILDTREES_DIR}/${logname}-out.log"
             ERROR_VARIABLE error
             WORKING_DIRECTORY "${arg_SOURCE_PATH}"
             RESULT_VARIABLE error_code
         )
         file(WRITE "${CURRENT_BUILDTREES_DIR}/${logname}-err.log" "${error}")
-
-        if(error_code AND NOT arg_QUIET)
-            message(FATAL_ERROR "Applying patch failed: ${error}")
+        if(NOT error_code)
+            set(batch_applied ON)
+            foreach(patch IN LISTS arg_PATCHES)
+                message(STATUS "Applied patch ${patch}")
+                file(APPEND "${results_log}" "applied: ${patch}\n")
+            endforeach()
+        else()
+            message(STATUS "Applying the patches together failed; applying them one at a time")
         endif()
+    endif()
 
-        math(EXPR patchnum "${patchnum} + 1")
-    endforeach()
+    if(NOT batch_applied)
+        set(patchnum 0)
+        foreach(patch absolute_patch IN ZIP_LISTS arg_PATCHES absolute_patches)
+            message(STATUS "Applying patch ${patch}")
+            set(logname "patch-${TARGET_TRIPLET}-${patchnum}")
+            vcpkg_execute_in_download_mode(
+                COMMAND ${git_apply_command} "${absolute_patch}"
+                OUTPUT_FILE "${CURRENT_BUILDTREES_DIR}/${logname}-out.log"
+                ERROR_VARIABLE error
+                WORKING_DIRECTORY "${arg_SOURCE_PATH}"
+                RESULT_VARIABLE error_code
+            )
+            file(WRITE "${CURRENT_BUILDTREES_DIR}/${logname}-err.log" "${error}")
+
+            if(error_code)
+                file(APPEND "${results_log}" "failed: ${patch} (see ${logname}-err.log)\n")
+                if(NOT arg_QUIET)
+                    message(FATAL_ERROR "Applying patch failed: ${error}")
+                endif()
+            else()
+                file(APPEND "${results_log}" "applied: ${patch}\n")
+            endif()
+
+            math(EXPR patchnum "${patchnum} + 1")
+        endforeach()
+    endif()
     if(DEFINED git_config_nosystem_backup)
         set(ENV{GIT_CONFIG_NOSYSTEM} "${git_config_nosystem_backup}")
     else()
         unset(ENV{GIT_CONFIG_NOSYSTEM})
     endif()
+    z_vcpkg_timing_end(patch "${CMAKE_CURRENT_FUNCTION}")
 endfunction()
@@ -0,0 +1,249 @@
+#[===[.md:
+# z_vcpkg_autoreconf_cache
+
+**Only for internal use in vcpkg helpers. Behavior and arguments will change without notice.**
+
+Reuse the output of `autoreconf` or `autogen.sh` from an earlier build.
+
+```cmake
+z_vcpkg_autoreconf_cache_restore(<out-restored> <out-entry>
+    SOURCE_PATH <source-directory>
+    SHELL <shell-command>...
+    [KEY <value>...]
+)
+z_vcpkg_autoreconf_cache_store(<entry> SOURCE_PATH <source-directory>)
+```
+
+When the `VCPKG_CACHE_AUTORECONF_OUTPUT` triplet variable is set to `ON`,
+`z_vcpkg_autoreconf_cache_restore()` looks up the generated build system of `<source-directory>`
+in `${DOWNLOADS}/autoreconf-output`.
+On a hit, the generated files are copied into `<source-directory>`, `<out-restored>` is set to `ON`,
+and `<out-entry>` is set to an empty string.
+On a miss, `<out-restored>` is set to `OFF` and `<out-entry>` is set to the cache entry;
+after generating the build system, the caller passes that entry to `z_vcpkg_autoreconf_cache_store()`,
+which stores every file that changed in `<source-directory>` since the lookup.
+If the cache is disabled, `<out-restored>` is set to `OFF` and `<out-entry>` to an empty string.
+
+The entries are keyed on
+- the contents of `configure.ac`, `configure.in`, `*.am`, `Makefile.inc`, `*.mk`, `*.m4` and `autogen.sh` files in `<source-directory>`,
+- the contents of other files which `*.am` files include with automake's `include` directive,
+- the versions of autoconf, automake, libtool and gettext which `<shell-command>` finds,
+- the `.m4` files in the system directories of `aclocal` and in `ACLOCAL_PATH`,
+- the environment variables which select or configure the autotools,
+- and the `KEY` values.
+
+Restored files are touched in dependency order, so that the generated makefiles
+do not run the autotools again.
+#]===]
+
+set(Z_VCPKG_AUTORECONF_CACHE_FORMAT 1)
+set(Z_VCPKG_AUTORECONF_CACHE_ENVIRONMENT
+    ACLOCAL ACLOCAL_FLAGS ACLOCAL_PATH AUTOCONF AUTOHEADER AUTOM4TE AUTOMAKE AUTOPOINT AUTORECONF
+    GTKDOCIZE INTLTOOLIZE LIBTOOLIZE M4 NOCONFIGURE
+)
+
+# Appends "<relative-path>:<sha1>" of every file in <directory> which matches one of the <globs>.
+function(z_vcpkg_autoreconf_cache_hash_files out_var directory)
+    if(NOT IS_DIRECTORY "${directory}")
+        return()
+    endif()
+    set(globs "")
+    foreach(glob IN LISTS ARGN)
+        list(APPEND globs "${directory}/${glob}")
+    endforeach()
+    file(GLOB_RECURSE files LIST_DIRECTORIES false RELATIVE "${directory}" ${globs})
+    list(FILTER files EXCLUDE REGEX "(^|/)autom4te\\.cache/")
+    list(SORT files)
+    set(hashes "${${out_var}}")
+    foreach(file IN LISTS files)
+        file(SHA1 "${directory}/${file}" hash)
+        list(APPEND hashes "${file}:${hash}")
+    endforeach()
+    set("${out_var}" "${hashes}" PARENT_SCOPE)
+endfunction()
+
+# Appends "<relative-path>:<sha1>" of every file in <directory> which a `*.am` file includes with automake's
+# `include` directive and which is not already matched by the <globs>.
+function(z_vcpkg_autoreconf_cache_hash_includes out_var directory globs_regex)
+    file(GLOB_RECURSE makefiles LIST_DIRECTORIES false RELATIVE "${directory}" "${directory}/*.am")
+    list(FILTER makefiles EXCLUDE REGEX "(^|/)autom4te\\.cache/")
+    set(files "")
+    foreach(makefile IN LISTS makefiles)
+        cmake_path(GET makefile PARENT_PATH makefile_dir)
+        file(STRINGS "${directory}/${makefile}" lines REGEX "^[ \t]*-?include[ \t]")
+        foreach(line IN LISTS lines)
+            string(REGEX REPLACE "^[ \t]*-?include[ \t]+" "" file "${line}")
+            string(STRIP "${file}" file)
+            if(file MATCHES "^\\$[({]top_srcdir[)}]/(.*)")
+                set(file "${CMAKE_MATCH_1}")
+            elseif(file MATCHES "^\\$[({]srcdir[)}]/(.*)")
+                cmake_path(APPEND makefile_dir "${CMAKE_MATCH_1}" OUTPUT_VARIABLE file)
+            elseif(file MATCHES "\\$" OR IS_ABSOLUTE "${file}")
+                # other variables are only known to configure; those files are not part of the key
+                continue()
+            else()
+                cmake_path(APPEND makefile_dir "${file}" OUTPUT_VARIABLE file)
+            endif()
+            cmake_path(NORMAL_PATH file)
+            if(NOT file MATCHES "^\\.\\./" AND NOT file MATCHES "${globs_regex}" AND EXISTS "${directory}/${file}")
+                list(APPEND files "${file}")
+            endif()
+        endforeach()
+    endforeach()
+    list(REMOVE_DUPLICATES files)
+    list(SORT files)
+    set(hashes "${${out_var}}")
+    foreach(file IN LISTS files)
+        file(SHA1 "${directory}/${file}" hash)
+        list(APPEND hashes "${file}:${hash}")
+    endforeach()
+    set("${out_var}" "${hashes}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_autoreconf_cache_restore out_restored out_entry)
+    cmake_parse_arguments(PARSE_ARGV 2 "arg" "" "SOURCE_PATH" "SHELL;KEY")
+
+    if(DEFINED arg_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed extra arguments: ${arg_UNPARSED_ARGUMENTS}")
+    endif()
+    foreach(required_arg IN ITEMS SOURCE_PATH SHELL)
+        if(NOT DEFINED arg_${required_arg})
+            message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} requires a ${required_arg} argument")
+        endif()
+    endforeach()
+
+    set("${out_restored}" OFF PARENT_SCOPE)
+    set("${out_entry}" "" PARENT_SCOPE)
+    if(NOT VCPKG_CACHE_AUTORECONF_OUTPUT)
+        return()
+    endif()
+
+    set(key_inputs "${Z_VCPKG_AUTORECONF_CACHE_FORMAT}" ${arg_KEY})
+    z_vcpkg_autoreconf_cache_hash_files(key_inputs "${arg_SOURCE_PATH}"
+        configure.ac configure.in *.am Makefile.inc *.mk *.m4 autogen.sh
+    )
+    z_vcpkg_autoreconf_cache_hash_includes(key_inputs "${arg_SOURCE_PATH}"
+        "(^|/)(configure\\.ac|configure\\.in|Makefile\\.inc|autogen\\.sh|[^/]*\\.(am|mk|m4))$"
+    )
+
+    # The tools are run through the shell which also runs autoreconf, so that the same ones are found.
+    execute_process(
+        COMMAND ${arg_SHELL} -c [[
+for tool in "${AUTOCONF:-autoconf}" "${AUTOMAKE:-automake}" "${LIBTOOLIZE:-libtoolize}" "${AUTOPOINT:-autopoint}"; do
+    $tool --version 2>/dev/null | sed -n 1p
+done
+echo "aclocal-dirs:$(${ACLOCAL:-aclocal} --print-ac-dir 2>/dev/null):${ACLOCAL_PATH}"
+]]
+        WORKING_DIRECTORY "${arg_SOURCE_PATH}"
+        OUTPUT_VARIABLE tool_versions
+        ERROR_QUIET
+    )
+    string(REPLACE "\r" "" tool_versions "${tool_versions}")
+    list(APPEND key_inputs "${tool_versions}")
+    if(tool_versions MATCHES "aclocal-dirs:([^\n]*)")
+        string(REPLACE ":" ";" aclocal_dirs "${CMAKE_MATCH_1}")
+        list(REMOVE_DUPLICATES aclocal_dirs)
+        foreach(aclocal_dir IN LISTS aclocal_dirs)
+            # on Windows, these are paths of the MSYS2 shell; those which are not native paths are only keyed by name
+            if(NOT aclocal_dir STREQUAL "" AND IS_ABSOLUTE "${aclocal_dir}")
+                z_vcpkg_autoreconf_cache_hash_files(key_inputs "${aclocal_dir}" *.m4)
+            endif()
+        endforeach()
+    endif()
+    foreach(env_var IN LISTS Z_VCPKG_AUTORECONF_CACHE_ENVIRONMENT)
+        if(DEFINED ENV{${env_var}})
+            list(APPEND key_inputs "${env_var}=$ENV{${env_var}}")
+        endif()
+    endforeach()
+
+    string(SHA512 cache_key "${key_inputs}")
+    string(SUBSTRING "${cache_key}" 0 32 cache_key)
+    set(entry "${DOWNLOADS}/autoreconf-output/${PORT}-${cache_key}")
+    debug_message("autoreconf cache key inputs: ${key_inputs}")
+
+    if(EXISTS "${entry}/files.txt")
+        message(STATUS "Restoring generated configure for ${TARGET_TRIPLET} from ${entry}")
+        file(COPY "${entry}/tree/" DESTINATION "${arg_SOURCE_PATH}")
+        file(STRINGS "${entry}/files.txt" files)
+
+        # Touch the restored files after their inputs, and aclocal.m4 before the files generated from it,
+        # so that the rebuild rules of automake see an up to date tree.
+        set(first_files "")
+        set(aclocal_files "")
+        set(last_files "")
+        foreach(file IN LISTS files)
+            if(file MATCHES "(^|/)aclocal\\.m4$")
+                list(APPEND aclocal_files "${arg_SOURCE_PATH}/${file}")
+            elseif(file MATCHES "\\.m4$")
+                list(APPEND first_files "${arg_SOURCE_PATH}/${file}")
+            else()
+                list(APPEND last_files "${arg_SOURCE_PATH}/${file}")
+            endif()
+        endforeach()
+        foreach(group IN ITEMS first_files aclocal_files last_files)
+            if(NOT "${${group}}" STREQUAL "")
+                file(TOUCH_NOCREATE ${${group}})
+            endif()
+        endforeach()
+
+        set("${out_restored}" ON PARENT_SCOPE)
+        return()
+    endif()
+
+    # Files with a modification time after the stamp are the output of the autotools.
+    # The short sleep separates the stamp from files which were patched just before.
+    set(stamp "${CURRENT_BUILDTREES_DIR}/autoreconf-${TARGET_TRIPLET}.stamp")
+    execute_process(COMMAND "${CMAKE_COMMAND}" -E sleep 0.05)
+    file(TOUCH "${stamp}")
+    set("${out_entry}" "${entry}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_autoreconf_cache_store entry)
+    cmake_parse_arguments(PARSE_ARGV 1 "arg" "" "SOURCE_PATH" "")
+
+    if(DEFINED arg_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed extra arguments: ${arg_UNPARSED_ARGUMENTS}")
+    endif()
+    if(NOT DEFINED arg_SOURCE_PATH)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} requires a SOURCE_PATH argument")
+    endif()
+
+    set(stamp "${CURRENT_BUILDTREES_DIR}/autoreconf-${TARGET_TRIPLET}.stamp")
+    if(NOT EXISTS "${stamp}")
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} must be called after z_vcpkg_autoreconf_cache_restore")
+    endif()
+
+    file(GLOB_RECURSE candidates LIST_DIRECTORIES false RELATIVE "${arg_SOURCE_PATH}" "${arg_SOURCE_PATH}/*")
+    list(FILTER candidates EXCLUDE REGEX "(^|/)autom4te\\.cache/")
+    set(files "")
+    foreach(file IN LISTS candidates)
+        if("${arg_SOURCE_PATH}/${file}" IS_NEWER_THAN "${stamp}")
+            list(APPEND files "${file}")
+        endif()
+    endforeach()
+    file(REMOVE "${stamp}")
+    if(files STREQUAL "")
+        debug_message("autoreconf did not change any files in ${arg_SOURCE_PATH}; not caching")
+        return()
+    endif()
+
+    cmake_path(GET entry PARENT_PATH cache_dir)
+    file(MAKE_DIRECTORY "${cache_dir}")
+    file(LOCK "${entry}.lock" GUARD FUNCTION)
+    if(EXISTS "${entry}/files.txt")
+        return()
+    endif()
+
+    string(RANDOM LENGTH 8 suffix)
+    set(temp_entry "${entry}.${suffix}.tmp")
+    file(REMOVE_RECURSE "${temp_entry}" "${entry}")
+    foreach(file IN LISTS files)
+        cmake_path(GET file PARENT_PATH file_dir)
+        file(COPY "${arg_SOURCE_PATH}/${file}" DESTINATION "${temp_entry}/tree/${file_dir}")
+    endforeach()
+    list(JOIN files "\n" files_text)
+    file(WRITE "${temp_entry}/files.txt" "${files_text}\n")
+    file(RENAME "${temp_entry}" "${entry}")
+    list(LENGTH files file_count)
+    message(STATUS "Stored ${file_count} generated files in ${entry}")
+endfunction()
@@ -0,0 +1,65 @@
+#[===[.md:
+# z_vcpkg_clone_directory
+
+**Only for internal use in vcpkg helpers. Behavior and arguments will change without notice.**
+
+Copy the contents of a directory into a new directory.
+
+```cmake
+z_vcpkg_clone_directory(
+    SOURCE <source-directory>
+    DESTINATION <destination-directory>
+)
+```
+
+`<destination-directory>` must not exist yet; it is created with the same contents
+and permissions as `<source-directory>`.
+Where the host supports it, file data is shared with copy-on-write clones
+(`cp --reflink=auto` with GNU coreutils, `cp -c` on macOS),
+so cloning a tree on a filesystem like btrfs, XFS or APFS is nearly free.
+Otherwise, or if cloning fails, this falls back to a regular `file(COPY)`.
+
+The destination never shares storage that can be modified through it,
+so it is safe to patch or otherwise edit the resulting files in place.
+#]===]
+
+function(z_vcpkg_clone_directory)
+    cmake_parse_arguments(PARSE_ARGV 0 "arg" "" "SOURCE;DESTINATION" "")
+
+    if(DEFINED arg_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed extra arguments: ${arg_UNPARSED_ARGUMENTS}")
+    endif()
+    foreach(required_arg IN ITEMS SOURCE DESTINATION)
+        if(NOT DEFINED arg_${required_arg})
+            message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} requires a ${required_arg} argument")
+        endif()
+    endforeach()
+    if(EXISTS "${arg_DESTINATION}")
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION}: destination '${arg_DESTINATION}' already exists")
+    endif()
+
+    set(clone_command "")
+    if(CMAKE_HOST_APPLE)
+        set(clone_command cp -c -R -p)
+    elseif(CMAKE_HOST_UNIX)
+        set(clone_command cp -a --reflink=auto)
+    endif()
+
+    if(NOT clone_command STREQUAL "")
+        file(MAKE_DIRECTORY "${arg_DESTINATION}")
+        vcpkg_execute_in_download_mode(
+            COMMAND ${clone_command} "${arg_SOURCE}/." "${arg_DESTINATION}"
+            OUTPUT_QUIET
+            ERROR_QUIET
+            RESULT_VARIABLE error_code
+        )
+        if(error_code EQUAL "0")
+            return()
+        endif()
+        debug_message("Cloning '${arg_SOURCE}' failed (${error_code}); falling back to copying")
+        file(REMOVE_RECURSE "${arg_DESTINATION}")
+    endif()
+
+    file(MAKE_DIRECTORY "${arg_DESTINATION}")
+    file(COPY "${arg_SOURCE}/" DESTINATION "${arg_DESTINATION}")
+endfunction()
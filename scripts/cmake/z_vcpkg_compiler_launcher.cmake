@@ -0,0 +1,160 @@
+#[===[.md:
+# z_vcpkg_compiler_launcher
+
+**Only for internal use in vcpkg helpers. Behavior and arguments will change without notice.**
+
+Route compilations through the compiler cache named by the `VCPKG_COMPILER_LAUNCHER` triplet variable.
+
+```cmake
+z_vcpkg_get_compiler_launcher(<out-var>)
+z_vcpkg_compiler_launcher(BEGIN|END)
+```
+
+`VCPKG_COMPILER_LAUNCHER` is a list of a program, such as `ccache` or `sccache`, and optional arguments to it.
+`z_vcpkg_get_compiler_launcher()` sets `<out-var>` to that list with the program resolved to a full path,
+or to an empty string if the variable is not set or the program cannot be found.
+The build helpers prepend it to the compiler:
+CMake projects through the `CMAKE_C_COMPILER_LAUNCHER` and `CMAKE_CXX_COMPILER_LAUNCHER` environment variables,
+autotools projects through `CC` and `CXX`, and Meson projects through the compiler entries of the native and cross files.
+
+`z_vcpkg_compiler_launcher(BEGIN)` sets up those environment variables and records the statistics of the cache;
+`z_vcpkg_compiler_launcher(END)` writes the difference to
+`${CURRENT_BUILDTREES_DIR}/compiler-cache-${TARGET_TRIPLET}.log` and prints the number of hits and misses.
+Statistics are only available for `ccache` (version 3.7 or newer) and `sccache`.
+#]===]
+
+function(z_vcpkg_get_compiler_launcher out_var)
+    set("${out_var}" "" PARENT_SCOPE)
+    if(NOT DEFINED VCPKG_COMPILER_LAUNCHER OR VCPKG_COMPILER_LAUNCHER STREQUAL "")
+        return()
+    endif()
+
+    list(POP_FRONT VCPKG_COMPILER_LAUNCHER program)
+    if(NOT IS_ABSOLUTE "${program}")
+        find_program(Z_VCPKG_COMPILER_LAUNCHER_PROGRAM NAMES "${program}")
+        set(resolved_program "${Z_VCPKG_COMPILER_LAUNCHER_PROGRAM}")
+    elseif(EXISTS "${program}")
+        set(resolved_program "${program}")
+    else()
+        set(resolved_program "")
+    endif()
+    if(NOT resolved_program)
+        get_property(warned GLOBAL PROPERTY Z_VCPKG_COMPILER_LAUNCHER_WARNED)
+        if(NOT warned)
+            message(WARNING "Could not find the compiler launcher '${program}' from VCPKG_COMPILER_LAUNCHER; building without it.")
+            set_property(GLOBAL PROPERTY Z_VCPKG_COMPILER_LAUNCHER_WARNED ON)
+        endif()
+        return()
+    endif()
+    set(program "${resolved_program}")
+    set("${out_var}" "${program}" ${VCPKG_COMPILER_LAUNCHER} PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_compiler_launcher_read_stats out_var launcher_kind program)
+    set(stats "")
+    if(launcher_kind STREQUAL "ccache")
+        vcpkg_execute_in_download_mode(
+            COMMAND "${program}" --print-stats
+            OUTPUT_VARIABLE output
+            ERROR_QUIET
+            RESULT_VARIABLE error_code
+        )
+        if(error_code EQUAL "0")
+            string(REGEX MATCHALL "[a-z_]+\t[0-9]+" lines "${output}")
+            foreach(line IN LISTS lines)
+                string(REPLACE "\t" "=" line "${line}")
+                list(APPEND stats "${line}")
+            endforeach()
+        endif()
+    elseif(launcher_kind STREQUAL "sccache")
+        vcpkg_execute_in_download_mode(
+            COMMAND "${program}" --show-stats --stats-format=json
+            OUTPUT_VARIABLE output
+            ERROR_QUIET
+            RESULT_VARIABLE error_code
+        )
+        if(error_code EQUAL "0")
+            string(JSON requests ERROR_VARIABLE json_error GET "${output}" stats compile_requests)
+            if(NOT json_error)
+                list(APPEND stats "compile_requests=${requests}")
+            endif()
+            foreach(kind IN ITEMS cache_hits cache_misses)
+                set(total 0)
+                string(JSON count ERROR_VARIABLE json_error LENGTH "${output}" stats "${kind}" counts)
+                if(NOT json_error AND count GREATER "0")
+                    math(EXPR last "${count} - 1")
+                    foreach(i RANGE "${last}")
+                        string(JSON language MEMBER "${output}" stats "${kind}" counts "${i}")
+                        string(JSON value GET "${output}" stats "${kind}" counts "${language}")
+                        math(EXPR total "${total} + ${value}")
+                    endforeach()
+                endif()
+                list(APPEND stats "${kind}=${total}")
+            endforeach()
+        endif()
+    endif()
+    set("${out_var}" "${stats}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_compiler_launcher mode)
+    z_vcpkg_get_compiler_launcher(launcher)
+    if(launcher STREQUAL "")
+        return()
+    endif()
+    list(GET launcher 0 program)
+    get_filename_component(launcher_kind "${program}" NAME_WE)
+    string(TOLOWER "${launcher_kind}" launcher_kind)
+
+    if(mode STREQUAL "BEGIN")
+        set(ENV{CMAKE_C_COMPILER_LAUNCHER} "${launcher}")
+        set(ENV{CMAKE_CXX_COMPILER_LAUNCHER} "${launcher}")
+        z_vcpkg_compiler_launcher_read_stats(stats "${launcher_kind}" "${program}")
+        set_property(GLOBAL PROPERTY Z_VCPKG_COMPILER_LAUNCHER_STATS "${stats}")
+        return()
+    elseif(NOT mode STREQUAL "END")
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed invalid mode: ${mode}")
+    endif()
+
+    get_property(begin_stats GLOBAL PROPERTY Z_VCPKG_COMPILER_LAUNCHER_STATS)
+    z_vcpkg_compiler_launcher_read_stats(end_stats "${launcher_kind}" "${program}")
+    if(end_stats STREQUAL "")
+        return()
+    endif()
+
+    set(report "")
+    foreach(entry IN LISTS end_stats)
+        string(REGEX MATCH "^([^=]+)=(.*)$" entry "${entry}")
+        set(key "${CMAKE_MATCH_1}")
+        set(value "${CMAKE_MATCH_2}")
+        set(begin_value 0)
+        foreach(begin_entry IN LISTS begin_stats)
+            if(begin_entry MATCHES "^${key}=(.*)$")
+                set(begin_value "${CMAKE_MATCH_1}")
+            endif()
+        endforeach()
+        math(EXPR "delta_${key}" "${value} - ${begin_value}")
+        if(NOT delta_${key} EQUAL "0" AND NOT key MATCHES "_timestamp$")
+            string(APPEND report "${key}: ${delta_${key}}\n")
+        endif()
+    endforeach()
+
+    if(launcher_kind STREQUAL "sccache")
+        set(hits "${delta_cache_hits}")
+        set(misses "${delta_cache_misses}")
+    else()
+        # ccache 4 and ccache 3 use different names for the same counters
+        set(hits 0)
+        foreach(key IN ITEMS direct_cache_hit preprocessed_cache_hit cache_hit_direct cache_hit_preprocessed)
+            if(DEFINED delta_${key})
+                math(EXPR hits "${hits} + ${delta_${key}}")
+            endif()
+        endforeach()
+        set(misses 0)
+        if(DEFINED delta_cache_miss)
+            set(misses "${delta_cache_miss}")
+        endif()
+    endif()
+
+    file(WRITE "${CURRENT_BUILDTREES_DIR}/compiler-cache-${TARGET_TRIPLET}.log" "${report}")
+    message(STATUS "Compiler cache (${launcher_kind}): ${hits} hits, ${misses} misses")
+endfunction()
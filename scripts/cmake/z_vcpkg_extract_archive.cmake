@@ -0,0 +1,123 @@
+#[===[.md:
+# z_vcpkg_extract_archive
+
+**Only for internal use in vcpkg helpers. Behavior and arguments will change without notice.**
+
+Extract an archive into a directory.
+
+```cmake
+z_vcpkg_extract_archive(
+    ARCHIVE <path-to-archive>
+    DESTINATION <directory>
+)
+```
+
+On non-Windows hosts, compressed tarballs are decompressed by a separate,
+multi-threaded decompressor when one is found on the `PATH`,
+which is piped into the host's `tar`.
+This lets decompression run in parallel with the file writes,
+and on multiple cores where the format allows it:
+
+| Archive                | Decompressor           |
+|------------------------|------------------------|
+| `.tar.gz`, `.tgz`      | `pigz`                 |
+| `.tar.xz`, `.txz`      | `xz -T<concurrency>`   |
+| `.tar.zst`, `.tzst`    | `zstd`                 |
+| `.tar.bz2`, `.tbz2`    | `lbzip2` or `pbzip2`   |
+
+The pipeline is only used if `DESTINATION` is empty or does not exist yet,
+since a failed pipeline leaves partially extracted files behind:
+`DESTINATION` is then removed and created again before the archive is extracted
+with `cmake -E tar xjf`, which is also used for all other archives.
+Logs are written to `${CURRENT_BUILDTREES_DIR}/extract-{out,err}.log`.
+#]===]
+
+function(z_vcpkg_extract_archive_get_decompressor out_var archive)
+    set("${out_var}" "" PARENT_SCOPE)
+    if(NOT CMAKE_HOST_UNIX)
+        return()
+    endif()
+
+    if(DEFINED VCPKG_CONCURRENCY)
+        set(threads "${VCPKG_CONCURRENCY}")
+    else()
+        set(threads 0)
+    endif()
+
+    if(archive MATCHES [[\.(tar\.gz|tgz)$]])
+        find_program(Z_VCPKG_PIGZ NAMES pigz)
+        set(program Z_VCPKG_PIGZ)
+        set(arguments -d -c)
+    elseif(archive MATCHES [[\.(tar\.xz|txz)$]])
+        find_program(Z_VCPKG_XZ NAMES xz)
+        set(program Z_VCPKG_XZ)
+        set(arguments -d -c "-T${threads}")
+    elseif(archive MATCHES [[\.(tar\.zst|tzst)$]])
+        find_program(Z_VCPKG_ZSTD NAMES zstd)
+        set(program Z_VCPKG_ZSTD)
+        set(arguments -d -c -q)
+    elseif(archive MATCHES [[\.(tar\.bz2|tbz2)$]])
+        find_program(Z_VCPKG_PARALLEL_BZIP2 NAMES lbzip2 pbzip2)
+        set(program Z_VCPKG_PARALLEL_BZIP2)
+        set(arguments -d -c)
+    else()
+        return()
+    endif()
+
+    find_program(Z_VCPKG_HOST_TAR NAMES tar gtar)
+    if(${program} AND Z_VCPKG_HOST_TAR)
+        set("${out_var}" "${${program}}" ${arguments} PARENT_SCOPE)
+    endif()
+endfunction()
+
+function(z_vcpkg_extract_archive)
+    z_vcpkg_timing_begin(extract)
+    cmake_parse_arguments(PARSE_ARGV 0 "arg" "" "ARCHIVE;DESTINATION" "")
+
+    if(DEFINED arg_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed extra arguments: ${arg_UNPARSED_ARGUMENTS}")
+    endif()
+    foreach(required_arg IN ITEMS ARCHIVE DESTINATION)
+        if(NOT DEFINED arg_${required_arg})
+            message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} requires a ${required_arg} argument")
+        endif()
+    endforeach()
+
+    file(MAKE_DIRECTORY "${arg_DESTINATION}")
+    file(GLOB existing_files "${arg_DESTINATION}/*" "${arg_DESTINATION}/.*")
+
+    set(extracted OFF)
+    set(decompress_command "")
+    if(existing_files STREQUAL "")
+        z_vcpkg_extract_archive_get_decompressor(decompress_command "${arg_ARCHIVE}")
+    endif()
+    if(NOT decompress_command STREQUAL "")
+        vcpkg_execute_in_download_mode(
+            COMMAND ${decompress_command} "${arg_ARCHIVE}"
+            COMMAND "${Z_VCPKG_HOST_TAR}" -x -f - --no-same-owner
+            WORKING_DIRECTORY "${arg_DESTINATION}"
+            OUTPUT_FILE "${CURRENT_BUILDTREES_DIR}/extract-out.log"
+            ERROR_FILE "${CURRENT_BUILDTREES_DIR}/extract-err.log"
+            RESULTS_VARIABLE error_codes
+        )
+        if(error_codes STREQUAL "0;0")
+            set(extracted ON)
+        else()
+            list(GET decompress_command 0 decompressor)
+            message(STATUS "Extracting with ${decompressor} failed (${error_codes}); retrying with cmake -E tar")
+            # the destination was empty, so only the partial results of the pipeline are removed
+            file(REMOVE_RECURSE "${arg_DESTINATION}")
+            file(MAKE_DIRECTORY "${arg_DESTINATION}")
+        endif()
+    endif()
+
+    if(NOT extracted)
+        vcpkg_execute_required_process(
+            ALLOW_IN_DOWNLOAD_MODE
+            COMMAND "${CMAKE_COMMAND}" -E tar xjf "${arg_ARCHIVE}"
+            WORKING_DIRECTORY "${arg_DESTINATION}"
+            LOGNAME extract
+        )
+    endif()
+    z_vcpkg_timing_end(extract "${CMAKE_CURRENT_FUNCTION}")
+endfunction()
@@ -0,0 +1,217 @@
+#[===[.md:
+# z_vcpkg_make_configure_cache
+
+**Only for internal use in vcpkg helpers. Behavior and arguments will change without notice.**
+
+Share the results of autoconf feature checks between the ports of a triplet.
+
+```cmake
+z_vcpkg_make_configure_cache_seed(<out-var>
+    CONFIGURE_SCRIPT <configure>
+    WORKING_DIRECTORY <build-directory>
+    BUILD_TYPE <RELEASE|DEBUG>
+    [OPTIONS <configure-option>...]
+    [KEY <value>...]
+)
+z_vcpkg_make_configure_cache_update(<shared-cache> WORKING_DIRECTORY <build-directory>)
+```
+
+When the `VCPKG_MAKE_CONFIGURE_CACHE` triplet variable is set to `ON`,
+`z_vcpkg_make_configure_cache_seed()` copies the shared cache of the build type
+into `<build-directory>/config.cache` and sets `<out-var>` to the path of the shared cache.
+The configure script is then run with `--cache-file=config.cache`.
+`<out-var>` is set to an empty string if the cache is not used for this configure run, which is the case
+- for ports in `Z_VCPKG_MAKE_CONFIGURE_CACHE_DENYLIST`,
+- for configure scripts which were not generated by autoconf,
+- and when the `OPTIONS` already select a cache file.
+
+The shared caches are stored in `buildtrees/_autoconf_cache`.
+They are keyed on the triplet, the build type, the hashes of the C and C++ compilers,
+the compiler and linker flags of the environment, the build, host and target options,
+the variable assignments among the `OPTIONS`, and the `KEY` values.
+
+After a successful configure run, `z_vcpkg_make_configure_cache_update()` merges the results
+from `<build-directory>/config.cache` into the shared cache.
+Only results which cannot depend on the ports that are installed at that time are shared:
+properties of the compiler, the linker and libtool, sizes of the basic C types, standard types,
+and headers which were found outside of the installed tree.
+All other results, and the values of the precious variables, stay in the cache of the port.
+#]===]
+
+# Ports whose configure scripts cannot use a cache shared with other ports.
+set(Z_VCPKG_MAKE_CONFIGURE_CACHE_DENYLIST
+    # choose their own compiler flags and ABI, which change the sizes of types
+    gmp
+    mpir
+    # run the configure scripts of bundled packages with other compiler flags
+    openmpi
+)
+
+set(Z_VCPKG_MAKE_CONFIGURE_CACHE_FORMAT 2)
+set(Z_VCPKG_MAKE_CONFIGURE_CACHE_NAME_REGEX [[[A-Za-z_][A-Za-z0-9_]*]])
+# unquoted values, and single-quoted values without embedded quotes
+set(Z_VCPKG_MAKE_CONFIGURE_CACHE_VALUE_REGEX [[('[^']*'|[^'"\$` ]*)]])
+# Sizes are only shared for types which feature macros such as _FILE_OFFSET_BITS or _TIME_BITS
+# cannot change, and the results of the largefile checks are not shared,
+# since ports define these macros differently.
+set(Z_VCPKG_MAKE_CONFIGURE_CACHE_SHARED_REGEX
+    "^(ac_cv_(sizeof|alignof)_(char|short|int|long|long_long|unsigned_char|unsigned_short|unsigned_int|unsigned_long|unsigned_long_long|float|double|void_p|size_t)|ac_cv_c_[A-Za-z0-9_]+|ac_cv_prog_(cc|cxx)_[A-Za-z0-9_]+|ac_cv_cxx_compiler_gnu|ac_cv_(objext|exeext)|ac_cv_(build|host|target)|ac_cv_path_(EGREP|FGREP|GREP|SED)|ac_cv_header_[A-Za-z0-9_]+|ac_cv_type_(_Bool|signal|size_t|ssize_t|off_t|pid_t|mode_t|uid_t|gid_t|ptrdiff_t|intptr_t|uintptr_t|intmax_t|uintmax_t|long_long_int|unsigned_long_long_int|long_double|u?int(8|16|32|64)_t)|lt_cv_[A-Za-z0-9_]+)$"
+)
+
+# Reads the entries of an autoconf cache file into the variables
+# <prefix>_names and <prefix>_line_<name>, in the scope of the caller.
+# Both the format of autoconf up to 2.69 and the format of autoconf 2.70 are recognized,
+# and lines which are not entries in either format are ignored.
+function(z_vcpkg_make_configure_cache_read prefix cache_file)
+    set(names "")
+    if(EXISTS "${cache_file}")
+        set(name_regex "${Z_VCPKG_MAKE_CONFIGURE_CACHE_NAME_REGEX}")
+        set(value_regex "${Z_VCPKG_MAKE_CONFIGURE_CACHE_VALUE_REGEX}")
+        file(STRINGS "${cache_file}" lines REGEX "^(test |${name_regex}=)")
+        foreach(line IN LISTS lines)
+            # a failed MATCHES clears CMAKE_MATCH_<n>, so the formats are not tested in a single if()
+            if(line MATCHES "^(${name_regex})=\\\${${name_regex}=${value_regex}}$")
+            elseif(line MATCHES "^test \\\${(${name_regex})\\+y} \\|\\| ${name_regex}=${value_regex}$")
+            else()
+                continue()
+            endif()
+            set(name "${CMAKE_MATCH_1}")
+            set(value "${CMAKE_MATCH_2}")
+            if(value MATCHES "^'(.*)'$")
+                set(value "${CMAKE_MATCH_1}")
+            endif()
+            list(APPEND names "${name}")
+            set("${prefix}_line_${name}" "${line}" PARENT_SCOPE)
+            set("${prefix}_value_${name}" "${value}" PARENT_SCOPE)
+        endforeach()
+        list(REMOVE_DUPLICATES names)
+    endif()
+    set("${prefix}_names" "${names}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_make_configure_cache_seed out_var)
+    cmake_parse_arguments(PARSE_ARGV 1 "arg" "" "CONFIGURE_SCRIPT;WORKING_DIRECTORY;BUILD_TYPE" "OPTIONS;KEY")
+
+    if(DEFINED arg_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed extra arguments: ${arg_UNPARSED_ARGUMENTS}")
+    endif()
+    foreach(required_arg IN ITEMS CONFIGURE_SCRIPT WORKING_DIRECTORY BUILD_TYPE)
+        if(NOT DEFINED arg_${required_arg})
+            message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} requires a ${required_arg} argument")
+        endif()
+    endforeach()
+
+    set("${out_var}" "" PARENT_SCOPE)
+    if(NOT VCPKG_MAKE_CONFIGURE_CACHE OR PORT IN_LIST Z_VCPKG_MAKE_CONFIGURE_CACHE_DENYLIST
+        OR NOT EXISTS "${arg_CONFIGURE_SCRIPT}")
+        return()
+    endif()
+    # On Windows, the options are already joined into a single command line.
+    list(JOIN arg_OPTIONS " " options)
+    if(options MATCHES "(^| )(--cache-file=|--config-cache|-C( |$))")
+        return()
+    endif()
+    file(STRINGS "${arg_CONFIGURE_SCRIPT}" generated_by LIMIT_COUNT 1 LIMIT_INPUT 4096 REGEX "Generated by GNU Autoconf")
+    if(generated_by STREQUAL "")
+        return()
+    endif()
+
+    set(key "${Z_VCPKG_MAKE_CONFIGURE_CACHE_FORMAT}" "${TARGET_TRIPLET}" "${arg_BUILD_TYPE}" ${arg_KEY})
+    foreach(compiler IN ITEMS "${VCPKG_DETECTED_CMAKE_C_COMPILER}" "${VCPKG_DETECTED_CMAKE_CXX_COMPILER}")
+        set(compiler_hash "")
+        if(NOT compiler STREQUAL "" AND EXISTS "${compiler}" AND NOT IS_DIRECTORY "${compiler}")
+            file(SHA1 "${compiler}" compiler_hash)
+        endif()
+        list(APPEND key "${compiler}" "${compiler_hash}")
+    endforeach()
+    foreach(env_var IN ITEMS CC CXX CPP CPPFLAGS CFLAGS CXXFLAGS LDFLAGS LIBS)
+        list(APPEND key "${env_var}=$ENV{${env_var}}")
+    endforeach()
+    # --prefix and the directory options name the port, so only these options go into the key
+    string(REGEX MATCHALL "(^| )(--(build|host|target)=[^ ]*|--(enable|disable)-(shared|static)|[A-Za-z_][A-Za-z0-9_]*=[^ ]*)"
+        key_options "${options}")
+    list(APPEND key ${key_options})
+    string(SHA1 key_hash "${key}")
+
+    cmake_path(GET CURRENT_BUILDTREES_DIR PARENT_PATH buildtrees_root)
+    set(cache_dir "${buildtrees_root}/_autoconf_cache")
+    set(shared_cache "${cache_dir}/${TARGET_TRIPLET}-${arg_BUILD_TYPE}-${key_hash}.cache")
+    file(MAKE_DIRECTORY "${cache_dir}")
+    file(REMOVE "${arg_WORKING_DIRECTORY}/config.cache")
+    file(LOCK "${shared_cache}.lock" GUARD FUNCTION)
+    if(EXISTS "${shared_cache}")
+        configure_file("${shared_cache}" "${arg_WORKING_DIRECTORY}/config.cache" COPYONLY)
+        z_vcpkg_make_configure_cache_read(seed "${shared_cache}")
+        list(LENGTH seed_names seed_count)
+        message(STATUS "Seeding the autoconf cache with ${seed_count} results of other ports")
+    endif()
+    file(LOCK "${shared_cache}.lock" RELEASE)
+    set("${out_var}" "${shared_cache}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_make_configure_cache_update shared_cache)
+    cmake_parse_arguments(PARSE_ARGV 1 "arg" "" "WORKING_DIRECTORY" "")
+
+    if(DEFINED arg_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed extra arguments: ${arg_UNPARSED_ARGUMENTS}")
+    endif()
+    if(NOT DEFINED arg_WORKING_DIRECTORY)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} requires a WORKING_DIRECTORY argument")
+    endif()
+
+    z_vcpkg_make_configure_cache_read(port "${arg_WORKING_DIRECTORY}/config.cache")
+    if(port_names STREQUAL "")
+        return()
+    endif()
+
+    # Header checks are named after the header with every character that is not alphanumeric replaced;
+    # headers of the installed tree may be missing from the next port's installed tree.
+    file(GLOB_RECURSE installed_headers LIST_DIRECTORIES false RELATIVE "${CURRENT_INSTALLED_DIR}/include"
+        "${CURRENT_INSTALLED_DIR}/include/*")
+    set(installed_header_names "|")
+    foreach(header IN LISTS installed_headers)
+        string(REPLACE "+" "p" header "${header}")
+        string(REGEX REPLACE "[^A-Za-z0-9]" "_" header "${header}")
+        string(APPEND installed_header_names "${header}|")
+    endforeach()
+
+    set(new_names "")
+    foreach(name IN LISTS port_names)
+        if(NOT name MATCHES "${Z_VCPKG_MAKE_CONFIGURE_CACHE_SHARED_REGEX}")
+            continue()
+        endif()
+        set(value "${port_value_${name}}")
+        if(name MATCHES "^ac_cv_header_(.*)$")
+            string(FIND "${installed_header_names}" "|${CMAKE_MATCH_1}|" installed_index)
+            if(NOT value STREQUAL "yes" OR NOT installed_index EQUAL "-1")
+                continue()
+            endif()
+        elseif(name MATCHES "^ac_cv_type_" AND NOT value STREQUAL "yes")
+            continue()
+        elseif(name MATCHES "^ac_cv_(sizeof|alignof)_" AND (value STREQUAL "0" OR value STREQUAL ""))
+            continue()
+        endif()
+        list(APPEND new_names "${name}")
+    endforeach()
+    if(new_names STREQUAL "")
+        return()
+    endif()
+
+    file(LOCK "${shared_cache}.lock" GUARD FUNCTION)
+    # the results of other ports are kept, and the results of this port are added
+    z_vcpkg_make_configure_cache_read(shared "${shared_cache}")
+    foreach(name IN LISTS new_names)
+        set(shared_line_${name} "${port_line_${name}}")
+    endforeach()
+    set(names ${shared_names} ${new_names})
+    list(REMOVE_DUPLICATES names)
+    list(SORT names)
+    set(contents "# autoconf results shared by the ports of ${TARGET_TRIPLET}\n")
+    foreach(name IN LISTS names)
+        string(APPEND contents "${shared_line_${name}}\n")
+    endforeach()
+    string(RANDOM LENGTH 8 suffix)
+    file(WRITE "${shared_cache}.${suffix}.tmp" "${contents}")
+    file(RENAME "${shared_cache}.${suffix}.tmp" "${shared_cache}")
+    file(LOCK "${shared_cache}.lock" RELEASE)
+endfunction()
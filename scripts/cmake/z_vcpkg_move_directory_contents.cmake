@@ -0,0 +1,49 @@
+#[===[.md:
+# z_vcpkg_move_directory_contents
+
+**Only for internal use in vcpkg helpers. Behavior and arguments will change without notice.**
+
+Move the contents of a directory into another directory, and remove the emptied source directory.
+
+```cmake
+z_vcpkg_move_directory_contents(
+    SOURCE <source-directory>
+    DESTINATION <destination-directory>
+)
+```
+
+The result is the same as `file(COPY <source-directory>/ DESTINATION <destination-directory>)`
+followed by `file(REMOVE_RECURSE <source-directory>)`:
+subdirectories are merged into existing ones, and files replace existing files of the same name.
+However, entries are moved with `file(RENAME)`, so no file data is copied.
+Both directories must be on the same filesystem, which always holds within `${CURRENT_PACKAGES_DIR}`.
+#]===]
+
+function(z_vcpkg_move_directory_contents)
+    cmake_parse_arguments(PARSE_ARGV 0 "arg" "" "SOURCE;DESTINATION" "")
+
+    if(DEFINED arg_UNPARSED_ARGUMENTS)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} was passed extra arguments: ${arg_UNPARSED_ARGUMENTS}")
+    endif()
+    foreach(required_arg IN ITEMS SOURCE DESTINATION)
+        if(NOT DEFINED arg_${required_arg})
+            message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION} requires a ${required_arg} argument")
+        endif()
+    endforeach()
+
+    file(MAKE_DIRECTORY "${arg_DESTINATION}")
+    file(GLOB entries LIST_DIRECTORIES true "${arg_SOURCE}/*")
+    foreach(entry IN LISTS entries)
+        get_filename_component(entry_name "${entry}" NAME)
+        set(destination_entry "${arg_DESTINATION}/${entry_name}")
+        if(IS_DIRECTORY "${entry}" AND NOT IS_SYMLINK "${entry}" AND IS_DIRECTORY "${destination_entry}")
+            z_vcpkg_move_directory_contents(SOURCE "${entry}" DESTINATION "${destination_entry}")
+        else()
+            if(IS_DIRECTORY "${destination_entry}" AND NOT IS_SYMLINK "${destination_entry}")
+                message(FATAL_ERROR "Cannot move '${entry}' over the directory '${destination_entry}'.")
+            endif()
+            file(RENAME "${entry}" "${destination_entry}")
+        endif()
+    endforeach()
+    file(REMOVE_RECURSE "${arg_SOURCE}")
+endfunction()
@@ -0,0 +1,237 @@
+#[===[.md:
+# z_vcpkg_prefetch_downloads
+
+**Only for internal use in vcpkg helpers. Behavior and arguments will change without notice.**
+
+Fetch the files that a port needs concurrently, before its portfile asks for them one at a time.
+
+```cmake
+z_vcpkg_prefetch_downloads()
+z_vcpkg_prefetch_downloads_record(<filename> <sha512> <url>...)
+z_vcpkg_prefetch_downloads_fetch(<entry>...)
+```
+
+When the `VCPKG_PREFETCH_DOWNLOADS` triplet variable is set to `ON`,
+`z_vcpkg_prefetch_downloads()`, which runs before the portfile, collects the download plan of the port:
+it runs `ports.cmake` for the same port in another process, in download mode and with `Z_VCPKG_PREFETCH_COLLECT` set.
+In that collection pass, `vcpkg_download_distfile()` records every file with a known SHA512 instead of downloading it,
+and `vcpkg_extract_source_archive()` and `vcpkg_from_git()` return the source path without extracting or fetching anything.
+The pass ends at the first command that download mode does not allow, usually the configure step,
+or at the first command that needs a file which was not downloaded.
+This covers the sources and patches of most ports, including ports with several source archives.
+The buildtrees, packages and downloads directories of the pass are a scratch directory, which is removed afterwards.
+The output of the pass is written to `${CURRENT_BUILDTREES_DIR}/download-plan-${TARGET_TRIPLET}.log`.
+
+The plan is stored as `${CURRENT_BUILDTREES_DIR}/download-plan-${TARGET_TRIPLET}.txt`,
+together with a hash of the files of the port, its features, the triplet file and the vcpkg helpers.
+As long as none of these change, later builds reuse the plan instead of running the collection pass again.
+
+The files of the plan that are missing from `${DOWNLOADS}` are then downloaded,
+up to 8 files at a time, and at most 4 of them from the same host.
+The portfile then finds the files already in `${DOWNLOADS}`.
+Failed downloads are not an error at this point; the portfile downloads these files itself and reports the error.
+
+Each entry of a plan contains the SHA512, the file name and the URLs of a file, separated by tabs.
+`z_vcpkg_prefetch_downloads_fetch()` downloads the missing files among the given entries of this form in the same way,
+for helpers which know several files they need up front.
+#]===]
+
+function(z_vcpkg_prefetch_downloads_record filename sha512)
+    get_property(plan GLOBAL PROPERTY Z_VCPKG_PREFETCH_DOWNLOADS_RECORDING)
+    if("${plan}" STREQUAL "")
+        return()
+    endif()
+    list(JOIN ARGN "\t" urls)
+    file(APPEND "${plan}" "${sha512}\t${filename}\t${urls}\n")
+endfunction()
+
+# Sets out_var to a hash of the inputs of the collection pass: the port, its features, the triplet and the helpers.
+function(z_vcpkg_prefetch_downloads_key out_var)
+    file(GLOB_RECURSE port_files LIST_DIRECTORIES false "${CURRENT_PORT_DIR}/*")
+    file(GLOB helper_files LIST_DIRECTORIES false "${SCRIPTS}/cmake/*.cmake")
+    list(SORT port_files)
+    list(SORT helper_files)
+    set(key_inputs "${TARGET_TRIPLET}" "${FEATURES}")
+    foreach(file IN LISTS port_files helper_files CMAKE_TRIPLET_FILE)
+        file(SHA1 "${file}" hash)
+        list(APPEND key_inputs "${file}:${hash}")
+    endforeach()
+    string(SHA512 key "${key_inputs}")
+    set("${out_var}" "${key}" PARENT_SCOPE)
+endfunction()
+
+function(z_vcpkg_prefetch_downloads)
+    if(DEFINED Z_VCPKG_PREFETCH_COLLECT)
+        set_property(GLOBAL PROPERTY Z_VCPKG_PREFETCH_DOWNLOADS_RECORDING "${Z_VCPKG_PREFETCH_COLLECT}")
+        return()
+    endif()
+    if(NOT VCPKG_PREFETCH_DOWNLOADS OR NOT DEFINED PORT OR _VCPKG_NO_DOWNLOADS OR "$ENV{VCPKG_COMMAND}" STREQUAL "")
+        return()
+    endif()
+
+    # A plan which was collected for the same inputs is reused, so that the collection pass only runs
+    # after the port, its features, the triplet or the helpers changed.
+    z_vcpkg_prefetch_downloads_key(key)
+    set(plan "${CURRENT_BUILDTREES_DIR}/download-plan-${TARGET_TRIPLET}.txt")
+    if(EXISTS "${plan}")
+        file(STRINGS "${plan}" entries)
+        list(POP_FRONT entries plan_key)
+        if(plan_key STREQUAL "key:${key}")
+            z_vcpkg_prefetch_downloads_fetch(${entries})
+            return()
+        endif()
+    endif()
+
+    # The collection pass gets the same variables as this build of the port,
+    # except for the directories it may write to, which are replaced by a scratch directory.
+    set(scratch "${CURRENT_BUILDTREES_DIR}/download-plan-${TARGET_TRIPLET}")
+    set(scratch_directories BUILDTREES_DIR PACKAGES_DIR DOWNLOADS)
+    get_cmake_property(cache_variables CACHE_VARIABLES)
+    set(arguments "")
+    foreach(variable IN LISTS cache_variables)
+        get_property(type CACHE "${variable}" PROPERTY TYPE)
+        if(type STREQUAL "INTERNAL" OR type STREQUAL "STATIC" OR variable IN_LIST scratch_directories)
+            continue()
+        endif()
+        string(REPLACE ";" "\\;" value "$CACHE{${variable}}")
+        list(APPEND arguments "-D${variable}=${value}")
+    endforeach()
+    foreach(variable IN LISTS scratch_directories)
+        list(APPEND arguments "-D${variable}=${scratch}/${variable}")
+    endforeach()
+
+    file(REMOVE_RECURSE "${scratch}")
+    file(MAKE_DIRECTORY "${scratch}")
+    file(WRITE "${scratch}/plan.txt" "")
+    message(STATUS "Collecting the downloads of ${PORT}")
+    # The pass is expected to stop with an error, at the first step that it cannot run.
+    vcpkg_execute_in_download_mode(
+        COMMAND "${CMAKE_COMMAND}" ${arguments}
+            "-DZ_VCPKG_PREFETCH_COLLECT=${scratch}/plan.txt"
+            -DVCPKG_DOWNLOAD_MODE=ON
+            -P "${SCRIPTS}/ports.cmake"
+        OUTPUT_FILE "${CURRENT_BUILDTREES_DIR}/download-plan-${TARGET_TRIPLET}.log"
+        ERROR_FILE "${CURRENT_BUILDTREES_DIR}/download-plan-${TARGET_TRIPLET}.log"
+    )
+    file(STRINGS "${scratch}/plan.txt" entries)
+    file(REMOVE_RECURSE "${scratch}")
+    list(REMOVE_DUPLICATES entries)
+    list(JOIN entries "\n" entries_text)
+    file(WRITE "${plan}" "key:${key}\n${entries_text}\n")
+    z_vcpkg_prefetch_downloads_fetch(${entries})
+endfunction()
+
+function(z_vcpkg_prefetch_downloads_fetch)
+    if(_VCPKG_NO_DOWNLOADS OR "$ENV{VCPKG_COMMAND}" STREQUAL "")
+        return()
+    endif()
+
+    set(pending "")
+    set(pending_filenames "")
+    foreach(entry IN LISTS ARGN)
+        string(REPLACE "\t" ";" fields "${entry}")
+        list(LENGTH fields field_count)
+        if(field_count LESS "3")
+            continue()
+        endif()
+        list(GET fields 1 filename)
+        if(EXISTS "${DOWNLOADS}/${filename}" OR filename IN_LIST pending_filenames)
+            continue()
+        endif()
+        list(APPEND pending_filenames "${filename}")
+        list(APPEND pending "${entry}")
+    endforeach()
+    list(LENGTH pending pending_count)
+    if(pending_count LESS "2")
+        # there is nothing to gain over downloading the file directly
+        return()
+    endif()
+
+    z_vcpkg_timing_begin(download)
+    message(STATUS "Downloading ${pending_count} files concurrently")
+    set(max_downloads 8)
+    set(max_downloads_per_host 4)
+    while(NOT pending STREQUAL "")
+        set(commands "")
+        set(started "")
+        set(deferred "")
+        set(hosts "")
+        foreach(entry IN LISTS pending)
+            string(REPLACE "\t" ";" fields "${entry}")
+            list(GET fields 2 url)
+            set(host "${url}")
+            if(url MATCHES "^[A-Za-z]+://([^/]+)")
+                set(host "${CMAKE_MATCH_1}")
+            endif()
+            set(host_download_count 0)
+            foreach(started_host IN LISTS hosts)
+                if(started_host STREQUAL host)
+                    math(EXPR host_download_count "${host_download_count} + 1")
+                endif()
+            endforeach()
+            list(LENGTH started started_count)
+            if(started_count GREATER_EQUAL max_downloads OR host_download_count GREATER_EQUAL max_downloads_per_host)
+                list(APPEND deferred "${entry}")
+                continue()
+            endif()
+            list(APPEND hosts "${host}")
+            list(APPEND started "${entry}")
+            # The downloads run concurrently as the stages of one pipeline; they do not write to stdout.
+            list(APPEND commands COMMAND "${CMAKE_COMMAND}"
+                "-DDOWNLOADS=${DOWNLOADS}"
+                "-DZ_VCPKG_PREFETCH_ENTRY=${entry}"
+                -P "${CMAKE_CURRENT_FUNCTION_LIST_FILE}"
+            )
+        endforeach()
+        vcpkg_execute_in_download_mode(
+            ${commands}
+            OUTPUT_QUIET
+            ERROR_QUIET
+            RESULTS_VARIABLE results
+        )
+        foreach(entry result IN ZIP_LISTS started results)
+            if(NOT result EQUAL "0")
+                string(REPLACE "\t" ";" fields "${entry}")
+                list(GET fields 1 filename)
+                get_filename_component(log_name "${filename}" NAME)
+                message(STATUS "Prefetching ${filename} failed; see ${DOWNLOADS}/prefetch-${log_name}-err.log")
+            endif()
+        endforeach()
+        set(pending "${deferred}")
+    endwhile()
+    z_vcpkg_timing_end(download "${CMAKE_CURRENT_FUNCTION}")
+endfunction()
+
+if(DEFINED Z_VCPKG_PREFETCH_ENTRY AND CMAKE_SCRIPT_MODE_FILE STREQUAL CMAKE_CURRENT_LIST_FILE)
+    # Runs one download of z_vcpkg_prefetch_downloads_fetch() in its own process.
+    list(APPEND CMAKE_MODULE_PATH "${CMAKE_CURRENT_LIST_DIR}")
+    include(execute_process)
+    include(z_vcpkg_forward_output_variable)
+    include(vcpkg_download_distfile)
+
+    string(REPLACE "\t" ";" fields "${Z_VCPKG_PREFETCH_ENTRY}")
+    list(POP_FRONT fields sha512 filename)
+    set(urls "")
+    foreach(url IN LISTS fields)
+        list(APPEND urls "--url=${url}")
+    endforeach()
+    get_filename_component(log_name "${filename}" NAME)
+    set(log "${DOWNLOADS}/prefetch-${log_name}-err.log")
+    execute_process(
+        COMMAND "$ENV{VCPKG_COMMAND}" x-download
+            "${DOWNLOADS}/${filename}"
+            "${sha512}"
+            ${urls}
+            --feature-flags=-manifests # there's a bug in vcpkg x-download when it finds a manifest-root
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output
+        RESULT_VARIABLE failure
+        WORKING_DIRECTORY "${DOWNLOADS}"
+    )
+    if(failure)
+        file(WRITE "${log}" "${output}")
+        message(FATAL_ERROR "Failed to download ${filename}")
+    endif()
+    file(REMOVE "${log}")
+    z_vcpkg_download_distfile_write_sidecar("${DOWNLOADS}/${filename}" "${sha512}")
+endif()
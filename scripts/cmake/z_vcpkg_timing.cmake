@@ -0,0 +1,94 @@
+#[===[.md:
+# z_vcpkg_timing
+
+**Only for internal use in vcpkg helpers. Behavior and arguments will change without notice.**
+
+Record how long a phase of a port build takes.
+
+```cmake
+z_vcpkg_timing_begin(<phase>)
+...
+z_vcpkg_timing_end(<phase> <name>)
+```
+
+Every `z_vcpkg_timing_begin()` must be matched by a `z_vcpkg_timing_end()` with the same `<phase>`
+on every path out of the calling function, including early `return()`s.
+Pairs may nest; `z_vcpkg_timing_end()` always closes the innermost open phase.
+`<phase>` should be one of `download`, `extract`, `patch`, `configure`, `build`, `install` or `fixup`,
+and `<name>` is the helper that is being timed, usually `${CMAKE_CURRENT_FUNCTION}`.
+`ports.cmake` wraps the whole portfile in a `portfile` phase.
+
+When building a port, each completed phase is appended as one line to
+`${CURRENT_BUILDTREES_DIR}/timing-${TARGET_TRIPLET}.jsonl`; outside of a port build, nothing is recorded.
+Every line is a complete event in the Chrome trace-event format:
+
+```json
+{"name":"vcpkg_configure_cmake","cat":"configure","ph":"X","ts":1623456789123456,"dur":5321000,"pid":1,"tid":1,"args":{"port":"zlib","triplet":"x64-linux","cpu_ms":4870}}
+```
+
+`ts` and `dur` are in microseconds; with CMake versions older than 3.23, they only have a resolution of one second.
+`cpu_ms` is the user and system CPU time spent by vcpkg's CMake process and all of the processes it waited for,
+and is only recorded on Linux hosts.
+The file is recreated for every build of the port.
+`scripts/summarizeBuildTimes.py` aggregates these files across all ports in a buildtrees directory.
+#]===]
+
+function(z_vcpkg_timing_sample out_time out_cpu)
+    if(CMAKE_VERSION VERSION_GREATER_EQUAL "3.23")
+        string(TIMESTAMP now "%s%f" UTC)
+    else()
+        string(TIMESTAMP now "%s" UTC)
+        string(APPEND now "000000")
+    endif()
+    set("${out_time}" "${now}" PARENT_SCOPE)
+
+    set("${out_cpu}" "" PARENT_SCOPE)
+    if(CMAKE_HOST_SYSTEM_NAME STREQUAL "Linux" AND EXISTS "/proc/self/stat")
+        file(READ "/proc/self/stat" stat)
+        # The command name may contain spaces, so only look at the fields after it;
+        # utime, stime, cutime and cstime are fields 14 through 17, in units of 1/100 s.
+        string(REGEX REPLACE "^.*\\) " "" stat "${stat}")
+        string(REPLACE " " ";" stat "${stat}")
+        list(SUBLIST stat 11 4 cpu_times)
+        list(JOIN cpu_times " + " cpu_expression)
+        math(EXPR cpu_ms "(${cpu_expression}) * 10")
+        set("${out_cpu}" "${cpu_ms}" PARENT_SCOPE)
+    endif()
+endfunction()
+
+function(z_vcpkg_timing_begin phase)
+    z_vcpkg_timing_sample(start_time start_cpu)
+    set_property(GLOBAL APPEND PROPERTY Z_VCPKG_TIMING_STACK "${phase}:${start_time}:${start_cpu}")
+endfunction()
+
+function(z_vcpkg_timing_end phase name)
+    z_vcpkg_timing_sample(end_time end_cpu)
+    get_property(stack GLOBAL PROPERTY Z_VCPKG_TIMING_STACK)
+    if(stack STREQUAL "")
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION}(${phase}) called without a matching z_vcpkg_timing_begin")
+    endif()
+    list(POP_BACK stack entry)
+    set_property(GLOBAL PROPERTY Z_VCPKG_TIMING_STACK "${stack}")
+
+    string(REPLACE ":" ";" entry "${entry}")
+    list(GET entry 0 start_phase)
+    list(GET entry 1 start_time)
+    list(GET entry 2 start_cpu)
+    if(NOT start_phase STREQUAL phase)
+        message(FATAL_ERROR "internal error: ${CMAKE_CURRENT_FUNCTION}(${phase}) does not match the open phase ${start_phase}")
+    endif()
+
+    if(NOT DEFINED Z_VCPKG_TIMING_FILE)
+        return()
+    endif()
+
+    math(EXPR duration "${end_time} - ${start_time}")
+    set(args "\"port\":\"${PORT}\",\"triplet\":\"${TARGET_TRIPLET}\"")
+    if(NOT start_cpu STREQUAL "" AND NOT end_cpu STREQUAL "")
+        math(EXPR cpu_ms "${end_cpu} - ${start_cpu}")
+        string(APPEND args ",\"cpu_ms\":${cpu_ms}")
+    endif()
+    file(APPEND "${Z_VCPKG_TIMING_FILE}"
+        "{\"name\":\"${name}\",\"cat\":\"${phase}\",\"ph\":\"X\",\"ts\":${start_time},\"dur\":${duration},\"pid\":1,\"tid\":1,\"args\":{${args}}}\n"
+    )
+endfunction()
@@ -1,82 +1,159 @@
-import os
-import sys
-import json
-import time
-
-from pathlib import Path
-
-
-SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
-PORTS_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../ports')
-VERSIONS_DB_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../versions')
-
-
-def get_version_tag(version):
-    if 'version' in version:
-        return version['version']
-    elif 'version-date' in version:
-        return version['version-date']
-    elif 'version-semver' in version:
-        return version['version-semver']
-    elif 'version-string' in version:
-        return version['version-string']
-    sys.exit(1)
-
-
-def get_version_port_version(version):
-    if 'port-version' in version:
-        return version['port-version']
-    return 0
-
-
-def generate_baseline():
-    start_time = time.time()
-
-    # Assume each directory in ${VCPKG_ROOT}/ports is a different port
-    port_names = [item for item in os.listdir(
-        PORTS_DIRECTORY) if os.path.isdir(os.path.join(PORTS_DIRECTORY, item))]
-    port_names.sort()
-
-    baseline_entries = {}
-    total_count = len(port_names)
-    for i, port_name in enumerate(port_names, 1):
-        port_file_path = os.path.join(
-            VERSIONS_DB_DIRECTORY, f'{port_name[0]}-', f'{port_name}.json')
-
-        if not os.path.exists(port_file_path):
-            print(
-                f'Error: No version file for {port_name}.\n', file=sys.stderr)
-            continue
-        sys.stderr.write(
-            f'\rProcessed {i}/{total_count} ({i/total_count:.2%})')
-        with open(port_file_path, 'r') as db_file:
-            try:
-                versions_object = json.load(db_file)
-                if versions_object['versions']:
-                    last_version = versions_object['versions'][0]
-                    baseline_entries[port_name] = {
-                        'baseline': get_version_tag(last_version),
-                        'port-version': get_version_port_version(last_version)
-                    }
-            except json.JSONDecodeError as e:
-                print(f'Error: Decoding {port_file_path}\n{e}\n')
-    baseline_object = {}
-    baseline_object['default'] = baseline_entries
-
-    os.makedirs(VERSIONS_DB_DIRECTORY, exist_ok=True)
-    baseline_path = os.path.join(VERSIONS_DB_DIRECTORY, 'baseline.json')
-    with open(baseline_path, 'w') as baseline_file:
-        json.dump(baseline_object, baseline_file)
-
-    elapsed_time = time.time() - start_time
-    print(f'\nElapsed time: {elapsed_time:.2f} seconds')
-
-
-def main():
-    if not os.path.exists(VERSIONS_DB_DIRECTORY):
-        print(f'Version DB files must exist before generating a baseline.\nRun: `python generatePortVersionsDB`\n')
-    generate_baseline()
-
-
-if __name__ == "__main__":
-    main()
+import os
+import re
+import sys
+import json
+import time
+
+import multiprocessing
+
+from pathlib import Path
+
+from generateVersionsIndex import generate_versions_index
+
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+PORTS_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../ports')
+VERSIONS_DB_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../versions')
+MAX_PROCESSES = multiprocessing.cpu_count()
+READ_CHUNK_SIZE = 4096
+
+
+def get_version_tag(version):
+    if 'version' in version:
+        return version['version']
+    elif 'version-date' in version:
+        return version['version-date']
+    elif 'version-semver' in version:
+        return version['version-semver']
+    elif 'version-string' in version:
+        return version['version-string']
+    sys.exit(1)
+
+
+def get_version_port_version(version):
+    if 'port-version' in version:
+        return version['port-version']
+    return 0
+
+
+def read_head_version(port_file_path):
+    # Only the first entry of a versions file is needed, so the file is decoded
+    # incrementally and reading stops as soon as that entry is complete.
+    decoder = json.JSONDecoder()
+    text = ''
+    with open(port_file_path, 'r') as db_file:
+        while True:
+            chunk = db_file.read(READ_CHUNK_SIZE)
+            text += chunk
+            match = re.match(r'\s*\{\s*"versions"\s*:\s*\[\s*', text)
+            if match:
+                if text[match.end():match.end() + 1] == ']':
+                    return None
+                try:
+                    version, _ = decoder.raw_decode(text, match.end())
+                    return version
+                except json.JSONDecodeError:
+                    if not chunk:
+                        raise
+            elif not chunk or len(text) > READ_CHUNK_SIZE:
+                # not in the layout x-history writes; decode the whole file
+                db_file.seek(0)
+                versions = json.load(db_file)['versions']
+                return versions[0] if versions else None
+
+
+def get_baseline_entry(port_name):
+    port_file_path = os.path.join(
+        VERSIONS_DB_DIRECTORY, f'{port_name[0]}-', f'{port_name}.json')
+
+    if not os.path.exists(port_file_path):
+        return port_name, None, f'Error: No version file for {port_name}.'
+    try:
+        last_version = read_head_version(port_file_path)
+    except (json.JSONDecodeError, KeyError) as e:
+        return port_name, None, f'Error: Decoding {port_file_path}\n{e}'
+    if last_version is None:
+        return port_name, None, None
+    return port_name, {
+        'baseline': get_version_tag(last_version),
+        'port-version': get_version_port_version(last_version)
+    }, None
+
+
+def load_baseline(baseline_path):
+    if not os.path.exists(baseline_path):
+        return {}
+    with open(baseline_path, 'r') as baseline_file:
+        try:
+            return json.load(baseline_file).get('default', {})
+        except json.JSONDecodeError as e:
+            print(f'Warning: Ignoring {baseline_path}\n{e}', file=sys.stderr)
+            return {}
+
+
+def generate_baseline():
+    start_time = time.time()
+
+    # Assume each directory in ${VCPKG_ROOT}/ports is a different port
+    port_names = [item for item in os.listdir(
+        PORTS_DIRECTORY) if os.path.isdir(os.path.join(PORTS_DIRECTORY, item))]
+
+    os.makedirs(VERSIONS_DB_DIRECTORY, exist_ok=True)
+    baseline_path = os.path.join(VERSIONS_DB_DIRECTORY, 'baseline.json')
+    old_entries = load_baseline(baseline_path)
+
+    # Ports that are only left in the versions database keep their baseline
+    port_names += [port_name for port_name in old_entries if port_name not in port_names and os.path.exists(
+        os.path.join(VERSIONS_DB_DIRECTORY, f'{port_name[0]}-', f'{port_name}.json'))]
+    port_names.sort()
+
+    baseline_entries = dict.fromkeys(port_names)
+    total_count = len(port_names)
+    process_pool = multiprocessing.Pool(MAX_PROCESSES)
+    for i, (port_name, entry, error) in enumerate(
+            process_pool.imap_unordered(get_baseline_entry, port_names, chunksize=64), 1):
+        if error:
+            print(f'\n{error}\n', file=sys.stderr)
+            # keep the previous baseline of the port rather than dropping it
+            entry = old_entries.get(port_name)
+        baseline_entries[port_name] = entry
+        sys.stderr.write(
+            f'\rProcessed {i}/{total_count} ({i/total_count:.2%})')
+    process_pool.close()
+    process_pool.join()
+
+    # The entries are always written sorted by port name with the same formatting,
+    # so an unchanged database produces an identical file.
+    baseline_entries = {port_name: entry for port_name, entry in baseline_entries.items() if entry is not None}
+    changed = sorted(port_name for port_name, entry in baseline_entries.items()
+                     if old_entries.get(port_name) != entry)
+    removed = sorted(set(old_entries) - set(baseline_entries))
+    for port_name in changed:
+        print(f'\n{port_name}: {old_entries.get(port_name)} -> {baseline_entries[port_name]}', end='')
+    for port_name in removed:
+        print(f'\n{port_name}: removed', end='')
+
+    baseline_text = json.dumps({'default': baseline_entries}, indent=2) + '\n'
+    if changed or removed or not os.path.exists(baseline_path):
+        # write to a temporary file first, so readers never see a partial baseline
+        temporary_path = f'{baseline_path}.{os.getpid()}.tmp'
+        with open(temporary_path, 'w', newline='\n') as baseline_file:
+            baseline_file.write(baseline_text)
+        os.replace(temporary_path, baseline_path)
+    print(f'\n{len(changed)} changed, {len(removed)} removed')
+
+    elapsed_time = time.time() - start_time
+    print(f'Elapsed time: {elapsed_time:.2f} seconds')
+
+    # keep the binary index in sync with the JSON files
+    generate_versions_index()
+
+
+def main():
+    if not os.path.exists(VERSIONS_DB_DIRECTORY):
+        print(f'Version DB files must exist before generating a baseline.\nRun: `python generatePortVersionsDB`\n')
+    generate_baseline()
+
+
+if __name__ == "__main__":
+    main()
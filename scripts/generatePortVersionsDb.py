@@ -1,87 +1,273 @@
-import os
-import sys
-import subprocess
-import json
-import time
-import shutil
-
-import multiprocessing
-
-from pathlib import Path
-
-
-MAX_PROCESSES = multiprocessing.cpu_count()
-SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
-PORTS_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../ports')
-VERSIONS_DB_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../versions')
-
-
-def get_current_git_ref():
-    output = subprocess.run(['git', '-C', SCRIPT_DIRECTORY, 'rev-parse', '--verify', 'HEAD'],
-                            capture_output=True,
-                            encoding='utf-8')
-    if output.returncode == 0:
-        return output.stdout.strip()
-    print(f"Failed to get git ref:", output.stderr.strip(), file=sys.stderr)
-    return None
-
-
-def generate_versions_file(port_name):
-    containing_dir = os.path.join(VERSIONS_DB_DIRECTORY, f'{port_name[0]}-')
-    os.makedirs(containing_dir, exist_ok=True)
-
-    output_file_path = os.path.join(containing_dir, f'{port_name}.json')
-    if not os.path.exists(output_file_path):
-        env = os.environ.copy()
-        env['GIT_OPTIONAL_LOCKS'] = '0'
-        output = subprocess.run(
-            [os.path.join(SCRIPT_DIRECTORY, '../vcpkg'),
-             'x-history', port_name, '--x-json', f'--output={output_file_path}'],
-            capture_output=True, encoding='utf-8', env=env)
-        if output.returncode != 0:
-            print(f'x-history {port_name} failed: ',
-                  output.stdout.strip(), file=sys.stderr)
-
-
-def generate_versions_db(revision):
-    start_time = time.time()
-
-    # Assume each directory in ${VCPKG_ROOT}/ports is a different port
-    port_names = [item for item in os.listdir(
-        PORTS_DIRECTORY) if os.path.isdir(os.path.join(PORTS_DIRECTORY, item))]
-    total_count = len(port_names)
-
-    concurrency = MAX_PROCESSES / 2
-    print(f'Running {concurrency:.0f} parallel processes')
-    process_pool = multiprocessing.Pool(MAX_PROCESSES)
-    for i, _ in enumerate(process_pool.imap_unordered(generate_versions_file, port_names), 1):
-        sys.stderr.write(
-            f'\rProcessed: {i}/{total_count} ({(i / total_count):.2%})')
-    process_pool.close()
-    process_pool.join()
-
-    # Generate timestamp
-    rev_file = os.path.join(VERSIONS_DB_DIRECTORY, revision)
-    Path(rev_file).touch()
-
-    elapsed_time = time.time() - start_time
-    print(
-        f'\nElapsed time: {elapsed_time:.2f} seconds')
-
-
-def main():
-    revision = get_current_git_ref()
-    if not revision:
-        print('Couldn\'t fetch current Git revision', file=sys.stderr)
-        sys.exit(1)
-
-    rev_file = os.path.join(VERSIONS_DB_DIRECTORY, revision)
-    if os.path.exists(rev_file):
-        print(f'Database files already exist for commit {revision}')
-        sys.exit(0)
-
-    generate_versions_db(revision)
-
-
-if __name__ == "__main__":
-    main()
+import os
+import re
+import sys
+import subprocess
+import json
+import time
+import shutil
+import argparse
+import functools
+
+import multiprocessing
+
+from pathlib import Path
+
+from generateVersionsIndex import generate_versions_index
+
+
+MAX_PROCESSES = multiprocessing.cpu_count()
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+PORTS_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../ports')
+VERSIONS_DB_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../versions')
+
+
+def get_current_git_ref():
+    output = subprocess.run(['git', '-C', SCRIPT_DIRECTORY, 'rev-parse', '--verify', 'HEAD'],
+                            capture_output=True,
+                            encoding='utf-8')
+    if output.returncode == 0:
+        return output.stdout.strip()
+    print(f"Failed to get git ref:", output.stderr.strip(), file=sys.stderr)
+    return None
+
+
+def run_git(*args):
+    env = os.environ.copy()
+    env['GIT_OPTIONAL_LOCKS'] = '0'
+    return subprocess.run(['git', '-C', os.path.join(SCRIPT_DIRECTORY, '..')] + list(args),
+                          capture_output=True, encoding='utf-8', env=env)
+
+
+def find_base_revision():
+    # The marker files name the commits the database was generated for.
+    # The closest one that HEAD descends from is the base for an incremental update.
+    best_revision, best_distance = None, None
+    for name in os.listdir(VERSIONS_DB_DIRECTORY):
+        if not re.fullmatch('[0-9a-f]{40}', name):
+            continue
+        if run_git('merge-base', '--is-ancestor', name, 'HEAD').returncode != 0:
+            continue
+        output = run_git('rev-list', '--count', f'{name}..HEAD')
+        if output.returncode != 0:
+            continue
+        distance = int(output.stdout.strip())
+        if best_distance is None or distance < best_distance:
+            best_revision, best_distance = name, distance
+    return best_revision
+
+
+def get_port_trees(revision):
+    output = run_git('ls-tree', revision, 'ports/')
+    if output.returncode != 0:
+        print(f'Failed to list ports of {revision}:', output.stderr.strip(), file=sys.stderr)
+        sys.exit(1)
+    trees = {}
+    for line in output.stdout.splitlines():
+        info, path = line.split('\t', 1)
+        mode, kind, tree = info.split()
+        if kind == 'tree':
+            trees[path[len('ports/'):]] = tree
+    return trees
+
+
+def read_port_version(revision, port_name):
+    # Returns the entry that x-history would emit for the port at this revision, without the git-tree.
+    output = run_git('show', f'{revision}:ports/{port_name}/vcpkg.json')
+    if output.returncode == 0:
+        try:
+            manifest = json.loads(output.stdout)
+        except json.JSONDecodeError:
+            return None
+        for version_key in ['version', 'version-semver', 'version-date', 'version-string']:
+            if version_key in manifest:
+                return {version_key: manifest[version_key],
+                        'port-version': manifest.get('port-version', 0)}
+        return None
+
+    output = run_git('show', f'{revision}:ports/{port_name}/CONTROL')
+    if output.returncode != 0:
+        return None
+    fields = {}
+    for line in output.stdout.splitlines():
+        if not line.strip():
+            # only the first paragraph describes the port itself
+            break
+        match = re.match(r'([A-Za-z-]+):\s*(.*)$', line)
+        if match:
+            fields[match.group(1)] = match.group(2).strip()
+    if 'Version' not in fields:
+        return None
+    return {'version-string': fields['Version'],
+            'port-version': int(fields.get('Port-Version', '0') or '0')}
+
+
+def update_versions_file(base_revision, port_name):
+    output_file_path = os.path.join(VERSIONS_DB_DIRECTORY, f'{port_name[0]}-', f'{port_name}.json')
+    if not os.path.exists(output_file_path):
+        return 0, generate_versions_file(port_name)
+
+    with open(output_file_path, 'r') as versions_file:
+        versions_text = versions_file.read()
+    try:
+        known_trees = set(version['git-tree'] for version in json.loads(versions_text)['versions'])
+    except (json.JSONDecodeError, KeyError, TypeError) as e:
+        return 0, f'Error: Decoding {output_file_path}\n{e}'
+    versions_start = re.search(r'"versions"\s*:\s*\[', versions_text)
+    if not versions_start:
+        return 0, f'Error: No "versions" array in {output_file_path}'
+
+    output = run_git('rev-list', f'{base_revision}..HEAD', '--', f'ports/{port_name}')
+    if output.returncode != 0:
+        return 0, f'Failed to list the history of {port_name}: {output.stderr.strip()}'
+
+    # rev-list lists the newest commit first, which is the order of the versions file.
+    new_versions = []
+    for revision in output.stdout.split():
+        tree = run_git('rev-parse', '--verify', '--quiet', f'{revision}:ports/{port_name}')
+        if tree.returncode != 0:
+            # the port was removed in this commit
+            continue
+        tree = tree.stdout.strip()
+        if tree in known_trees:
+            continue
+        known_trees.add(tree)
+        version = read_port_version(revision, port_name)
+        if version is None:
+            # nothing is written, so that the next update adds the versions of the port in order
+            return 0, f'Error: Failed to read the version of {port_name} at {revision}'
+        new_versions.append(dict({'git-tree': tree}, **version))
+
+    if new_versions:
+        # The new entries are spliced into the text in the layout x-history writes,
+        # so that the existing entries stay byte for byte as they were.
+        entries_text = ',\n'.join(
+            re.sub('^', '    ', json.dumps(version, indent=2), flags=re.MULTILINE) for version in new_versions)
+        position = versions_start.end()
+        if re.match(r'\s*\]', versions_text[position:]):
+            entries_text = f'\n{entries_text}\n  '
+            position += len(re.match(r'\s*', versions_text[position:]).group(0))
+        else:
+            entries_text = f'\n{entries_text},'
+        versions_text = versions_text[:position] + entries_text + versions_text[position:]
+        with open(output_file_path, 'w', newline='\n') as versions_file:
+            versions_file.write(versions_text)
+    return len(new_versions), None
+
+
+def generate_versions_file(port_name):
+    containing_dir = os.path.join(VERSIONS_DB_DIRECTORY, f'{port_name[0]}-')
+    os.makedirs(containing_dir, exist_ok=True)
+
+    output_file_path = os.path.join(containing_dir, f'{port_name}.json')
+    if not os.path.exists(output_file_path):
+        env = os.environ.copy()
+        env['GIT_OPTIONAL_LOCKS'] = '0'
+        output = subprocess.run(
+            [os.path.join(SCRIPT_DIRECTORY, '../vcpkg'),
+             'x-history', port_name, '--x-json', f'--output={output_file_path}'],
+            capture_output=True, encoding='utf-8', env=env)
+        if output.returncode != 0:
+            return f'x-history {port_name} failed: {output.stdout.strip()}'
+    return None
+
+
+def generate_versions_db(revision):
+    start_time = time.time()
+
+    # Assume each directory in ${VCPKG_ROOT}/ports is a different port
+    port_names = [item for item in os.listdir(
+        PORTS_DIRECTORY) if os.path.isdir(os.path.join(PORTS_DIRECTORY, item))]
+    total_count = len(port_names)
+
+    concurrency = MAX_PROCESSES / 2
+    print(f'Running {concurrency:.0f} parallel processes')
+    process_pool = multiprocessing.Pool(MAX_PROCESSES)
+    for i, error in enumerate(process_pool.imap_unordered(generate_versions_file, port_names), 1):
+        if error:
+            print(f'\n{error}', file=sys.stderr)
+        sys.stderr.write(
+            f'\rProcessed: {i}/{total_count} ({(i / total_count):.2%})')
+    process_pool.close()
+    process_pool.join()
+
+    # Generate timestamp
+    rev_file = os.path.join(VERSIONS_DB_DIRECTORY, revision)
+    Path(rev_file).touch()
+
+    elapsed_time = time.time() - start_time
+    print(
+        f'\nElapsed time: {elapsed_time:.2f} seconds')
+
+    # keep the binary index in sync with the JSON files
+    generate_versions_index()
+
+
+def update_versions_db(base_revision, revision):
+    start_time = time.time()
+
+    # Only ports whose tree object changed can have new versions.
+    base_trees = get_port_trees(base_revision)
+    port_names = sorted(port_name for port_name, tree in get_port_trees(revision).items()
+                        if base_trees.get(port_name) != tree)
+    total_count = len(port_names)
+    print(f'{total_count} ports changed since {base_revision}')
+
+    new_count = 0
+    error_count = 0
+    if port_names:
+        process_pool = multiprocessing.Pool(MAX_PROCESSES)
+        for i, (count, error) in enumerate(process_pool.imap_unordered(
+                functools.partial(update_versions_file, base_revision), port_names), 1):
+            if error:
+                print(f'\n{error}\n', file=sys.stderr)
+                error_count += 1
+            new_count += count
+            sys.stderr.write(
+                f'\rProcessed: {i}/{total_count} ({(i / total_count):.2%})')
+        process_pool.close()
+        process_pool.join()
+
+    if error_count:
+        # Keep the base marker, so that the next run retries the ports that failed.
+        print(f'\n{error_count} ports failed; the database is still marked as generated for {base_revision}',
+              file=sys.stderr)
+        sys.exit(1)
+
+    # Move the timestamp
+    Path(os.path.join(VERSIONS_DB_DIRECTORY, revision)).touch()
+    os.remove(os.path.join(VERSIONS_DB_DIRECTORY, base_revision))
+
+    elapsed_time = time.time() - start_time
+    print(
+        f'\nAdded {new_count} versions\nElapsed time: {elapsed_time:.2f} seconds')
+
+    # keep the binary index in sync with the JSON files
+    generate_versions_index()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Generate the versions database from the git history of the ports.')
+    parser.add_argument('--full', action='store_true',
+                        help='regenerate missing files from the full history even if an earlier database exists')
+    args = parser.parse_args()
+
+    revision = get_current_git_ref()
+    if not revision:
+        print('Couldn\'t fetch current Git revision', file=sys.stderr)
+        sys.exit(1)
+
+    rev_file = os.path.join(VERSIONS_DB_DIRECTORY, revision)
+    if os.path.exists(rev_file):
+        print(f'Database files already exist for commit {revision}')
+        sys.exit(0)
+
+    base_revision = None if args.full else find_base_revision()
+    if base_revision:
+        update_versions_db(base_revision, revision)
+    else:
+        generate_versions_db(revision)
+
+
+if __name__ == "__main__":
+    main()
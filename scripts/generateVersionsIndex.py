@@ -0,0 +1,253 @@
+import os
+import sys
+import json
+import time
+import mmap
+import struct
+import argparse
+
+from pathlib import Path
+
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+VERSIONS_DB_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../versions')
+INDEX_PATH = os.path.join(VERSIONS_DB_DIRECTORY, 'versions.idx')
+
+# Layout of the index, all integers little-endian:
+#
+#   header:  magic, format version, port count, version count, string pool size
+#   ports:   one record per port, sorted by name:
+#            name (offset, length), baseline (offset, length), baseline port-version,
+#            index of the port's first version record, number of versions
+#   versions: one record per version, grouped by port and sorted by (version, port-version):
+#            version (offset, length), port-version, scheme, git-tree (20 bytes)
+#   strings: UTF-8 string pool referenced by the (offset, length) pairs
+#
+# A port without a baseline has a baseline offset of NO_BASELINE.
+MAGIC = b'VCPKGIDX'
+FORMAT_VERSION = 1
+HEADER = struct.Struct('<8sIIII')
+PORT_RECORD = struct.Struct('<IIIIIII')
+VERSION_RECORD = struct.Struct('<IIII20s')
+NO_BASELINE = 0xFFFFFFFF
+SCHEMES = ['version', 'version-semver', 'version-date', 'version-string']
+
+
+class StringPool:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, text):
+        encoded = text.encode('utf-8')
+        if encoded not in self.offsets:
+            self.offsets[encoded] = len(self.data)
+            self.data += encoded
+        return self.offsets[encoded], len(encoded)
+
+
+def get_version_scheme(version):
+    for scheme, key in enumerate(SCHEMES):
+        if key in version:
+            return scheme, version[key]
+    return None, None
+
+
+def get_versions_files():
+    for containing_dir in sorted(Path(VERSIONS_DB_DIRECTORY).glob('?-')):
+        for port_file in sorted(containing_dir.glob('*.json')):
+            yield port_file.stem, port_file
+
+
+def is_index_current(index_path):
+    # The JSON files are the source of truth; the index is stale if any of them is newer.
+    if not os.path.exists(index_path):
+        return False
+    index_time = os.path.getmtime(index_path)
+    baseline_path = os.path.join(VERSIONS_DB_DIRECTORY, 'baseline.json')
+    if os.path.exists(baseline_path) and os.path.getmtime(baseline_path) > index_time:
+        return False
+    for containing_dir in Path(VERSIONS_DB_DIRECTORY).glob('?-'):
+        if containing_dir.stat().st_mtime > index_time:
+            return False
+        for port_file in containing_dir.glob('*.json'):
+            if port_file.stat().st_mtime > index_time:
+                return False
+    return True
+
+
+def generate_versions_index(index_path=INDEX_PATH, force=False):
+    if not force and is_index_current(index_path):
+        print(f'Versions index {index_path} is up to date')
+        return
+
+    start_time = time.time()
+    baseline = {}
+    baseline_path = os.path.join(VERSIONS_DB_DIRECTORY, 'baseline.json')
+    if os.path.exists(baseline_path):
+        with open(baseline_path, 'r') as baseline_file:
+            baseline = json.load(baseline_file).get('default', {})
+
+    strings = StringPool()
+    port_records = []
+    version_records = []
+    port_names = {}
+    for port_name, port_file_path in get_versions_files():
+        port_names[port_name] = port_file_path
+    for port_name in baseline:
+        port_names.setdefault(port_name, None)
+
+    for port_name in sorted(port_names, key=lambda name: name.encode('utf-8')):
+        versions = []
+        port_file_path = port_names[port_name]
+        if port_file_path is not None:
+            with open(port_file_path, 'r') as db_file:
+                try:
+                    versions = json.load(db_file)['versions']
+                except (json.JSONDecodeError, KeyError) as e:
+                    print(f'Error: Decoding {port_file_path}\n{e}\n', file=sys.stderr)
+
+        entries = []
+        for version in versions:
+            scheme, version_text = get_version_scheme(version)
+            if scheme is None or 'git-tree' not in version:
+                print(f'Warning: Ignoring an entry of {port_file_path} without version or git-tree', file=sys.stderr)
+                continue
+            entries.append((version_text.encode('utf-8'), version.get('port-version', 0),
+                            scheme, bytes.fromhex(version['git-tree'])))
+        entries.sort(key=lambda entry: (entry[0], entry[1]))
+
+        first_version = len(version_records)
+        for version_bytes, port_version, scheme, git_tree in entries:
+            version_offset, version_length = strings.add(version_bytes.decode('utf-8'))
+            version_records.append(VERSION_RECORD.pack(
+                version_offset, version_length, port_version, scheme, git_tree))
+
+        name_offset, name_length = strings.add(port_name)
+        if port_name in baseline:
+            baseline_offset, baseline_length = strings.add(baseline[port_name]['baseline'])
+            baseline_port_version = baseline[port_name].get('port-version', 0)
+        else:
+            baseline_offset, baseline_length, baseline_port_version = NO_BASELINE, 0, 0
+        port_records.append(PORT_RECORD.pack(
+            name_offset, name_length, baseline_offset, baseline_length, baseline_port_version,
+            first_version, len(entries)))
+
+    # write to a temporary file first, so readers never map a partial index
+    temporary_path = f'{index_path}.{os.getpid()}.tmp'
+    with open(temporary_path, 'wb') as index_file:
+        index_file.write(HEADER.pack(MAGIC, FORMAT_VERSION, len(port_records),
+                                     len(version_records), len(strings.data)))
+        for record in port_records:
+            index_file.write(record)
+        for record in version_records:
+            index_file.write(record)
+        index_file.write(strings.data)
+    os.replace(temporary_path, index_path)
+
+    elapsed_time = time.time() - start_time
+    print(f'Wrote {len(port_records)} ports and {len(version_records)} versions to {index_path}')
+    print(f'Elapsed time: {elapsed_time:.2f} seconds')
+
+
+class VersionsIndex:
+    def __init__(self, index_path=INDEX_PATH):
+        with open(index_path, 'rb') as index_file:
+            self.data = mmap.mmap(index_file.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, format_version, self.port_count, self.version_count, _ = HEADER.unpack_from(self.data, 0)
+        if magic != MAGIC or format_version != FORMAT_VERSION:
+            raise ValueError(f'{index_path} is not a versions index of format {FORMAT_VERSION}')
+        self.ports_offset = HEADER.size
+        self.versions_offset = self.ports_offset + self.port_count * PORT_RECORD.size
+        self.strings_offset = self.versions_offset + self.version_count * VERSION_RECORD.size
+
+    def close(self):
+        self.data.close()
+
+    def _string(self, offset, length):
+        start = self.strings_offset + offset
+        return self.data[start:start + length]
+
+    def _port_record(self, i):
+        return PORT_RECORD.unpack_from(self.data, self.ports_offset + i * PORT_RECORD.size)
+
+    def _version_record(self, i):
+        return VERSION_RECORD.unpack_from(self.data, self.versions_offset + i * VERSION_RECORD.size)
+
+    def _find_port(self, port_name):
+        key = port_name.encode('utf-8')
+        low, high = 0, self.port_count
+        while low < high:
+            middle = (low + high) // 2
+            record = self._port_record(middle)
+            name = self._string(record[0], record[1])
+            if name < key:
+                low = middle + 1
+            elif name > key:
+                high = middle
+            else:
+                return record
+        return None
+
+    def get_baseline(self, port_name):
+        """Returns (version, port-version) of the port in the baseline, or None."""
+        record = self._find_port(port_name)
+        if record is None or record[2] == NO_BASELINE:
+            return None
+        return self._string(record[2], record[3]).decode('utf-8'), record[4]
+
+    def get_git_tree(self, port_name, version, port_version=0):
+        """Returns the git-tree of the port at that version, or None."""
+        record = self._find_port(port_name)
+        if record is None:
+            return None
+        key = (version.encode('utf-8'), port_version)
+        low, high = record[5], record[5] + record[6]
+        while low < high:
+            middle = (low + high) // 2
+            version_offset, version_length, entry_port_version, _, git_tree = self._version_record(middle)
+            entry = (self._string(version_offset, version_length), entry_port_version)
+            if entry < key:
+                low = middle + 1
+            else:
+                high = middle
+        if low == record[5] + record[6]:
+            return None
+        # equal versions keep the order of the versions file, so the lowest match is the newest
+        version_offset, version_length, entry_port_version, _, git_tree = self._version_record(low)
+        if (self._string(version_offset, version_length), entry_port_version) != key:
+            return None
+        return git_tree.hex()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Generate a binary index of the versions database for fast lookups.')
+    parser.add_argument('--force', action='store_true',
+                        help='regenerate the index even if it is newer than all versions files')
+    parser.add_argument('--lookup', nargs='+', metavar=('PORT', 'VERSION'),
+                        help='print the git-tree of PORT at VERSION[#PORT_VERSION] instead, '
+                             'or its baseline if no version is given')
+    args = parser.parse_args()
+
+    if not args.lookup:
+        generate_versions_index(force=args.force)
+        return
+
+    index = VersionsIndex()
+    port_name = args.lookup[0]
+    if len(args.lookup) == 1:
+        result = index.get_baseline(port_name)
+        result = result and f'{result[0]}#{result[1]}'
+    else:
+        version, _, port_version = args.lookup[1].partition('#')
+        result = index.get_git_tree(port_name, version, int(port_version or '0'))
+    index.close()
+    if result is None:
+        print(f'Error: Not found: {" ".join(args.lookup)}', file=sys.stderr)
+        sys.exit(1)
+    print(result)
+
+
+if __name__ == "__main__":
+    main()
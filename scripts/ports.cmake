@@ -135,10 +135,32 @@ if(CMD MATCHES "^BUILD$")
     include("${SCRIPTS}/cmake/vcpkg_test_cmake.cmake")
 
     include("${SCRIPTS}/cmake/z_vcpkg_apply_patches.cmake")
+    include("${SCRIPTS}/cmake/z_vcpkg_autoreconf_cache.cmake")
+    include("${SCRIPTS}/cmake/z_vcpkg_clone_directory.cmake")
+    include("${SCRIPTS}/cmake/z_vcpkg_compiler_launcher.cmake")
+    include("${SCRIPTS}/cmake/z_vcpkg_extract_archive.cmake")
     include("${SCRIPTS}/cmake/z_vcpkg_forward_output_variable.cmake")
+    include("${SCRIPTS}/cmake/z_vcpkg_make_configure_cache.cmake")
+    include("${SCRIPTS}/cmake/z_vcpkg_move_directory_contents.cmake")
+    include("${SCRIPTS}/cmake/z_vcpkg_prefetch_downloads.cmake")
     include("${SCRIPTS}/cmake/z_vcpkg_prettify_command_line.cmake")
+    include("${SCRIPTS}/cmake/z_vcpkg_timing.cmake")
 
+    if(DEFINED Z_VCPKG_PREFETCH_COLLECT)
+        # the collection pass of z_vcpkg_prefetch_downloads(), which only follows the downloads of the portfile
+        z_vcpkg_prefetch_downloads()
+        include("${CURRENT_PORT_DIR}/portfile.cmake")
+        return()
+    endif()
+
+    set(Z_VCPKG_TIMING_FILE "${CURRENT_BUILDTREES_DIR}/timing-${TARGET_TRIPLET}.jsonl")
+    file(REMOVE "${Z_VCPKG_TIMING_FILE}")
+    z_vcpkg_compiler_launcher(BEGIN)
+    z_vcpkg_timing_begin(portfile)
+    z_vcpkg_prefetch_downloads()
     include("${CURRENT_PORT_DIR}/portfile.cmake")
+    z_vcpkg_timing_end(portfile portfile.cmake)
+    z_vcpkg_compiler_launcher(END)
     if(DEFINED PORT)
         include("${SCRIPTS}/build_info.cmake")
     endif()
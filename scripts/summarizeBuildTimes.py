@@ -0,0 +1,140 @@
+import os
+import sys
+import json
+import argparse
+
+from pathlib import Path
+
+
+SCRIPT_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+BUILDTREES_DIRECTORY = os.path.join(SCRIPT_DIRECTORY, '../buildtrees')
+PHASES = ['download', 'extract', 'patch', 'configure', 'build', 'install', 'fixup', 'other']
+
+
+def load_timing_file(path):
+    events = []
+    with open(path, 'r') as timing_file:
+        for line_number, line in enumerate(timing_file, 1):
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                events.append(json.loads(line))
+            except json.JSONDecodeError as e:
+                print(f'Warning: Ignoring {path}:{line_number}: {e}', file=sys.stderr)
+    return events
+
+
+def charge_phases(events):
+    # Each event is charged with the time that none of the events nested in it account for.
+    # That time belongs to the event's own phase, except that everything below an install
+    # helper counts as install, since those mostly forward to the build helpers.
+    # Time spent in the portfile outside of any helper counts as 'other'.
+    wall = dict.fromkeys(PHASES, 0)
+    cpu = dict.fromkeys(PHASES, 0)
+    events = sorted(events, key=lambda e: (e['ts'], -e['dur']))
+    stack = []
+
+    def close(event):
+        nested_wall, nested_cpu = event['nested']
+        phase = event['phase']
+        wall[phase] += max(event['dur'] - nested_wall, 0)
+        cpu[phase] += max(event['cpu'] - nested_cpu, 0)
+        if stack:
+            stack[-1]['nested'][0] += event['dur']
+            stack[-1]['nested'][1] += event['cpu']
+
+    for event in events:
+        while stack and stack[-1]['end'] <= event['ts']:
+            close(stack.pop())
+        phase = event.get('cat', 'other')
+        if phase not in PHASES:
+            phase = 'other'
+        if stack and stack[-1]['phase'] == 'install':
+            phase = 'install'
+        stack.append({
+            'phase': phase,
+            'end': event['ts'] + event['dur'],
+            'dur': event['dur'],
+            'cpu': event.get('args', {}).get('cpu_ms', 0) * 1000,
+            'nested': [0, 0],
+        })
+    while stack:
+        close(stack.pop())
+    return wall, cpu
+
+
+def format_seconds(microseconds):
+    return f'{microseconds / 1000000:.1f}'
+
+
+def print_table(header, rows):
+    widths = [max(len(str(row[i])) for row in [header] + rows) for i in range(len(header))]
+    for row in [header] + rows:
+        cells = [str(cell).ljust(widths[0]) if i == 0 else str(cell).rjust(widths[i])
+                 for i, cell in enumerate(row)]
+        print('  '.join(cells))
+
+
+def summarize(buildtrees_directory, top, trace_path):
+    timing_files = sorted(Path(buildtrees_directory).glob('*/timing-*.jsonl'))
+    if not timing_files:
+        print(f'Error: No timing records found in {buildtrees_directory}', file=sys.stderr)
+        sys.exit(1)
+
+    per_port = []
+    total_wall = dict.fromkeys(PHASES, 0)
+    total_cpu = dict.fromkeys(PHASES, 0)
+    trace_events = []
+    for pid, timing_file in enumerate(timing_files, 1):
+        port_name = timing_file.parent.name
+        triplet = timing_file.stem[len('timing-'):]
+        events = load_timing_file(timing_file)
+        if not events:
+            continue
+        wall, cpu = charge_phases(events)
+        per_port.append((f'{port_name}:{triplet}', wall))
+        for phase in PHASES:
+            total_wall[phase] += wall[phase]
+            total_cpu[phase] += cpu[phase]
+
+        if trace_path:
+            trace_events.append({'name': 'process_name', 'ph': 'M', 'pid': pid,
+                                 'args': {'name': f'{port_name}:{triplet}'}})
+            for event in events:
+                trace_events.append(dict(event, pid=pid))
+
+    grand_total = sum(total_wall.values())
+    print(f'{len(per_port)} port builds, {format_seconds(grand_total)} s in portfiles\n')
+    rows = [[phase, format_seconds(total_wall[phase]), format_seconds(total_cpu[phase]),
+             f'{total_wall[phase] / grand_total:.1%}' if grand_total else '-']
+            for phase in PHASES]
+    print_table(['phase', 'wall (s)', 'cpu (s)', 'share'], rows)
+
+    print(f'\nSlowest {top} port builds (wall seconds):\n')
+    per_port.sort(key=lambda entry: sum(entry[1].values()), reverse=True)
+    rows = [[name, format_seconds(sum(wall.values()))] + [format_seconds(wall[phase]) for phase in PHASES]
+            for name, wall in per_port[:top]]
+    print_table(['port', 'total'] + PHASES, rows)
+
+    if trace_path:
+        with open(trace_path, 'w') as trace_file:
+            json.dump({'traceEvents': trace_events, 'displayTimeUnit': 'ms'}, trace_file)
+        print(f'\nWrote {len(trace_events)} trace events to {trace_path}')
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Summarize the per-phase timing records written by port builds.')
+    parser.add_argument('buildtrees', nargs='?', default=BUILDTREES_DIRECTORY,
+                        help='the buildtrees directory to scan (default: %(default)s)')
+    parser.add_argument('--top', type=int, default=20,
+                        help='number of port builds to list (default: %(default)s)')
+    parser.add_argument('--trace', metavar='FILE',
+                        help='also write all records into one Chrome trace-event file')
+    args = parser.parse_args()
+    summarize(args.buildtrees, args.top, args.trace)
+
+
+if __name__ == "__main__":
+    main()
@@ -61,9 +61,18 @@ endfunction()
 
 set(VCPKG_POLICY_EMPTY_PACKAGE enabled)
 
+if("acquire-msys" IN_LIST FEATURES)
+    include("${CMAKE_CURRENT_LIST_DIR}/test-vcpkg_acquire_msys.cmake")
+endif()
 if("list" IN_LIST FEATURES)
     include("${CMAKE_CURRENT_LIST_DIR}/test-vcpkg_list.cmake")
 endif()
+if("fixup-cmake-targets" IN_LIST FEATURES)
+    include("${CMAKE_CURRENT_LIST_DIR}/test-vcpkg_fixup_cmake_targets.cmake")
+endif()
+if("fixup-pkgconfig" IN_LIST FEATURES)
+    include("${CMAKE_CURRENT_LIST_DIR}/test-vcpkg_fixup_pkgconfig.cmake")
+endif()
 if("function-arguments" IN_LIST FEATURES)
     include("${CMAKE_CURRENT_LIST_DIR}/test-z_vcpkg_function_arguments.cmake")
 endif()
@@ -0,0 +1,62 @@
+# packages are served from a local directory, so this only needs a vcpkg which can download file:// URLs
+set(msys_mirror "${CURRENT_BUILDTREES_DIR}/msys-mirror")
+file(REMOVE_RECURSE "${msys_mirror}")
+# the packages and the roots assembled from them are kept out of the shared downloads directory
+set(msys_downloads_backup "${DOWNLOADS}")
+set(DOWNLOADS "${CURRENT_BUILDTREES_DIR}/msys-downloads")
+file(REMOVE_RECURSE "${DOWNLOADS}")
+# the archives are reproducible, and have new names in each run in case a downloads directory is left over
+string(RANDOM LENGTH 8 ALPHABET 0123456789abcdef msys_run)
+foreach(package IN ITEMS first second)
+    set(archive "${package}-1.0-${msys_run}-x86_64.pkg.tar.xz")
+    file(WRITE "${msys_mirror}/${package}/usr/bin/${package}" "${package}")
+    file(WRITE "${msys_mirror}/${package}/usr/share/unit-test-cmake/shared" "${package}")
+    vcpkg_execute_required_process(
+        COMMAND "${CMAKE_COMMAND}" -E tar cJf "${msys_mirror}/${archive}" "--mtime=2000-01-01 00:00:00 UTC" usr
+        WORKING_DIRECTORY "${msys_mirror}/${package}"
+        LOGNAME "msys-mirror-${package}"
+    )
+    file(SHA512 "${msys_mirror}/${archive}" "${package}_sha512")
+    set("${package}_url" "file://${msys_mirror}/${archive}")
+endforeach()
+
+function(check_acquire_msys)
+    vcpkg_acquire_msys(root NO_DEFAULT_PACKAGES DIRECT_PACKAGES ${ARGN})
+    if(Z_VCPKG_UNIT_TEST_HAS_FATAL_ERROR)
+        return()
+    endif()
+    file(READ "${root}/usr/bin/first" first)
+    file(READ "${root}/usr/bin/second" second)
+    file(READ "${root}/usr/share/unit-test-cmake/shared" shared)
+    set(contents "${first};${second};${shared}" PARENT_SCOPE)
+    set(root "${root}" PARENT_SCOPE)
+endfunction()
+function(check_acquire_msys_reversed)
+    check_acquire_msys("${first_url}" "${first_sha512}" "${second_url}" "${second_sha512}")
+    set(first_root "${root}")
+    check_acquire_msys("${second_url}" "${second_sha512}" "${first_url}" "${first_sha512}")
+    if(root STREQUAL first_root)
+        set(same_root ON PARENT_SCOPE)
+    else()
+        set(same_root OFF PARENT_SCOPE)
+    endif()
+    set(contents "${contents}" PARENT_SCOPE)
+endfunction()
+
+unit_test_check_variable_equal(
+    [[check_acquire_msys("${first_url}" "${first_sha512}" "${second_url}" "${second_sha512}")]]
+    contents "first;second;second"
+)
+# later packages overwrite the files of earlier ones, so the root depends on the order of the packages
+unit_test_check_variable_equal(
+    [[check_acquire_msys("${second_url}" "${second_sha512}" "${first_url}" "${first_sha512}")]]
+    contents "first;second;first"
+)
+unit_test_check_variable_equal(
+    [[check_acquire_msys_reversed()]]
+    same_root OFF
+)
+unit_test_ensure_fatal_error([[check_acquire_msys("${first_url}")]])
+
+file(REMOVE_RECURSE "${DOWNLOADS}" "${msys_mirror}")
+set(DOWNLOADS "${msys_downloads_backup}")
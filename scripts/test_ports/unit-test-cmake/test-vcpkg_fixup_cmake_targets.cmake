@@ -0,0 +1,106 @@
+set(fixup_cmake_targets_test_dir "${CURRENT_BUILDTREES_DIR}/fixup-cmake-targets-test")
+
+# Rewrites <input> as share/test/input.cmake into <destination>, with @installed@ and @packages@
+# standing for the installed and packages directories.
+# Sets output to the rewritten file and report to the lines written to the log.
+function(check_fixup_cmake_targets_rewrite input destination)
+    set(CURRENT_BUILDTREES_DIR "${fixup_cmake_targets_test_dir}")
+    set(CURRENT_INSTALLED_DIR "${fixup_cmake_targets_test_dir}/installed")
+    set(CURRENT_PACKAGES_DIR "${fixup_cmake_targets_test_dir}/packages")
+    set(TARGET_TRIPLET "test")
+    set(EXECUTABLE_SUFFIX ".exe")
+    set(arg_TOOLS_PATH "tools/test")
+    set(arg_NO_PREFIX_CORRECTION "${no_prefix_correction}")
+    file(REMOVE_RECURSE "${fixup_cmake_targets_test_dir}")
+
+    string(REPLACE "@installed@" "${CURRENT_INSTALLED_DIR}" input "${input}")
+    string(REPLACE "@packages@" "${CURRENT_PACKAGES_DIR}" input "${input}")
+    file(WRITE "${CURRENT_PACKAGES_DIR}/share/test/input.cmake" "${input}")
+    z_vcpkg_fixup_cmake_targets_rewrite(
+        "${CURRENT_PACKAGES_DIR}/share/test/input.cmake"
+        "${CURRENT_PACKAGES_DIR}/${destination}"
+        ${ARGN}
+    )
+    if(Z_VCPKG_UNIT_TEST_HAS_FATAL_ERROR)
+        return()
+    endif()
+
+    file(READ "${CURRENT_PACKAGES_DIR}/${destination}" output)
+    set(report "")
+    if(EXISTS "${fixup_cmake_targets_test_dir}/fixup-cmake-targets-test.log")
+        file(STRINGS "${fixup_cmake_targets_test_dir}/fixup-cmake-targets-test.log" report)
+    endif()
+    set(output "${output}" PARENT_SCOPE)
+    set(report "${report}" PARENT_SCOPE)
+endfunction()
+
+set(no_prefix_correction OFF)
+
+# release targets
+unit_test_check_variable_equal(
+    [=[check_fixup_cmake_targets_rewrite([[IMPORTED_LOCATION_RELEASE "@installed@/lib/test.lib"
+IMPORTED_LOCATION_RELEASE "${_IMPORT_PREFIX}/bin/tool.exe"
+]] share/test/input.cmake RELEASE_TARGETS)]=]
+    output [[IMPORTED_LOCATION_RELEASE "${_IMPORT_PREFIX}/lib/test.lib"
+IMPORTED_LOCATION_RELEASE "${_IMPORT_PREFIX}/tools/test/tool.exe"
+]]
+)
+unit_test_check_variable_equal(
+    [=[check_fixup_cmake_targets_rewrite([[IMPORTED_LOCATION_RELEASE "@installed@/lib/test.lib"
+IMPORTED_LOCATION_RELEASE "${_IMPORT_PREFIX}/bin/tool.exe"
+]] share/test/input.cmake RELEASE_TARGETS)]=]
+    report "share/test/input.cmake: absolute installed paths to _IMPORT_PREFIX;share/test/input.cmake: executables in bin to tools/test"
+)
+
+# debug targets
+unit_test_check_variable_equal(
+    [=[check_fixup_cmake_targets_rewrite([[IMPORTED_LOCATION_DEBUG "${_IMPORT_PREFIX}/lib/test.lib;${_IMPORT_PREFIX}/bin/test.dll"
+IMPORTED_LOCATION_DEBUG "${_IMPORT_PREFIX}/bin/tool.exe"
+]] share/test/input.cmake DEBUG_TARGETS)]=]
+    output [[IMPORTED_LOCATION_DEBUG "${_IMPORT_PREFIX}/debug/lib/test.lib;${_IMPORT_PREFIX}/debug/bin/test.dll"
+IMPORTED_LOCATION_DEBUG "${_IMPORT_PREFIX}/tools/test/tool.exe"
+]]
+)
+
+# _IMPORT_PREFIX and PACKAGE_PREFIX_DIR are computed two directories up from share/<port>
+unit_test_check_variable_equal(
+    [=[check_fixup_cmake_targets_rewrite([[get_filename_component(_IMPORT_PREFIX "${CMAKE_CURRENT_LIST_FILE}" PATH)
+get_filename_component(_IMPORT_PREFIX "${_IMPORT_PREFIX}" PATH)
+get_filename_component(PACKAGE_PREFIX_DIR "${CMAKE_CURRENT_LIST_DIR}/../../../" ABSOLUTE)
+]] share/test/input.cmake)]=]
+    output [[get_filename_component(_IMPORT_PREFIX "${CMAKE_CURRENT_LIST_FILE}" PATH)
+get_filename_component(_IMPORT_PREFIX "${_IMPORT_PREFIX}" PATH)
+get_filename_component(_IMPORT_PREFIX "${_IMPORT_PREFIX}" PATH)
+get_filename_component(PACKAGE_PREFIX_DIR "${CMAKE_CURRENT_LIST_DIR}/../../" ABSOLUTE)
+]]
+)
+set(no_prefix_correction ON)
+unit_test_check_variable_equal(
+    [=[check_fixup_cmake_targets_rewrite([[get_filename_component(_IMPORT_PREFIX "${CMAKE_CURRENT_LIST_FILE}" PATH)
+get_filename_component(PACKAGE_PREFIX_DIR "${CMAKE_CURRENT_LIST_DIR}/../../../" ABSOLUTE)
+]] share/test/input.cmake)]=]
+    output [[get_filename_component(_IMPORT_PREFIX "${CMAKE_CURRENT_LIST_FILE}" PATH)
+get_filename_component(PACKAGE_PREFIX_DIR "${CMAKE_CURRENT_LIST_DIR}/../../../" ABSOLUTE)
+]]
+)
+set(no_prefix_correction OFF)
+
+# absolute paths into the packages directory are only rewritten in top-level files
+unit_test_check_variable_equal(
+    [=[check_fixup_cmake_targets_rewrite([[set(TEST_INCLUDE_DIRS "@packages@/include")
+]] share/test/input.cmake TOP_LEVEL)]=]
+    output [[set(TEST_INCLUDE_DIRS "${CMAKE_CURRENT_LIST_DIR}/../../include")
+]]
+)
+
+# files which are not changed are neither written nor reported, unless they are moved
+unit_test_check_variable_equal(
+    [=[check_fixup_cmake_targets_rewrite([[set(TEST_FOUND TRUE)
+]] share/test/input.cmake)]=]
+    report ""
+)
+unit_test_check_variable_equal(
+    [=[check_fixup_cmake_targets_rewrite([[set(TEST_FOUND TRUE)
+]] share/moved/input.cmake)]=]
+    report "share/test/input.cmake: moved to share/moved/input.cmake"
+)
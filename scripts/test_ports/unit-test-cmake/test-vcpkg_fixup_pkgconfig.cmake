@@ -0,0 +1,116 @@
+set(pkgconfig_test_dir "${CURRENT_BUILDTREES_DIR}/fixup-pkgconfig-test")
+file(REMOVE_RECURSE "${pkgconfig_test_dir}")
+file(WRITE "${pkgconfig_test_dir}/expanded.pc" [[
+prefix=/usr
+exec_prefix=${prefix}
+libdir=${exec_prefix}/lib
+major=1
+version=${major}.2
+Name: expanded
+Description: variables are expanded
+Version: ${version}
+Requires: zlib >= ${version}, libpng
+Libs: -L${libdir} -lexpanded
+]])
+file(WRITE "${pkgconfig_test_dir}/continued.pc" [[
+# a comment line
+Name: continued
+Description: a field \
+  continued on the next line
+Version: 2.0 # a trailing comment
+Requires: first \
+  second > 1.0
+Requires.private: third
+]])
+file(WRITE "${pkgconfig_test_dir}/unspaced.pc" [[
+Name: unspaced
+Description: operators without whitespace
+Version: 1.0
+Requires: first>=1.0,second!= 2.0 third <3
+]])
+file(WRITE "${pkgconfig_test_dir}/broken.pc" [[
+Name: broken
+Version: ${undefined}
+Libs: -L"/path with spaces -lbroken
+]])
+
+# z_vcpkg_fixup_pkgconfig_parse(<out-prefix> <pc-file>)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/expanded.pc")]]
+    pc_version "1.2"
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/expanded.pc")]]
+    pc_requires "zlib >= 1.2;libpng"
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/expanded.pc")]]
+    pc_errors ""
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/continued.pc")]]
+    pc_version "2.0"
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/continued.pc")]]
+    pc_requires "first;second > 1.0"
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/continued.pc")]]
+    pc_requires.private "third"
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/continued.pc")]]
+    pc_errors ""
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/unspaced.pc")]]
+    pc_requires "first >= 1.0;second != 2.0;third < 3"
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_parse(pc "${pkgconfig_test_dir}/broken.pc")]]
+    pc_errors "missing the 'Description' field;variable 'undefined' is not defined;unbalanced quotes in the 'libs' field"
+)
+
+# z_vcpkg_fixup_pkgconfig_compare_versions(<out-var> <lhs> <rhs>)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.0 1.0)]]
+    result 0
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.10 1.9)]]
+    result 1
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.9 1.10)]]
+    result -1
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 2.0 10.0)]]
+    result -1
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.01 1.1)]]
+    result 0
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.0 1.0.0)]]
+    result -1
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.0a 1.0)]]
+    result 1
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.0 1.0a)]]
+    result -1
+)
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.0a 1.0b)]]
+    result -1
+)
+# a number is newer than letters
+unit_test_check_variable_equal(
+    [[z_vcpkg_fixup_pkgconfig_compare_versions(result 1.0.1 1.0a)]]
+    result 1
+)